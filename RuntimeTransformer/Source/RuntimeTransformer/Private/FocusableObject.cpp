@@ -4,3 +4,15 @@
 #include "FocusableObject.h"
 
 // Add default functionality here for any IFocusableObject functions that are not pure virtual.
+
+void IFocusableObject::OnNewTransformation_Implementation(ATransformerActor* Caller, USceneComponent* Component, const FTransform& NewTransform, bool bComponentBased)
+{
+}
+
+void IFocusableObject::OnNewTransformations_Implementation(ATransformerActor* Caller, const TArray<USceneComponent*>& Components, const TArray<FTransform>& NewTransforms, bool bComponentBased)
+{
+	//by default every Component is notified on its own
+	UObject* object = _getUObject();
+	for (int32 i = 0; i < Components.Num() && i < NewTransforms.Num(); ++i)
+		Execute_OnNewTransformation(object, Caller, Components[i], NewTransforms[i], bComponentBased);
+}
@@ -0,0 +1,117 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "GizmoPoolSubsystem.h"
+#include "Engine/World.h"
+#include "Gizmos/BaseGizmo.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Gizmos"), STAT_RTT_PooledGizmos, STATGROUP_RuntimeTransformer);
+
+void UGizmoPoolSubsystem::Deinitialize()
+{
+	for (ABaseGizmo* gizmo : FreeGizmos)
+		if (IsValid(gizmo)) gizmo->Destroy();
+	for (ABaseGizmo* gizmo : LeasedGizmos)
+		if (IsValid(gizmo)) gizmo->Destroy();
+
+	DEC_DWORD_STAT_BY(STAT_RTT_PooledGizmos, FreeGizmos.Num() + LeasedGizmos.Num());
+	FreeGizmos.Empty();
+	LeasedGizmos.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UGizmoPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGizmoPoolSubsystem::Prewarm(TSubclassOf<ABaseGizmo> GizmoClass, int32 Count)
+{
+	if (!GizmoClass) return;
+
+	RemoveInvalidGizmos();
+
+	for (ABaseGizmo* gizmo : FreeGizmos)
+		if (gizmo->GetClass() == GizmoClass)
+			--Count;
+
+	for (; Count > 0; --Count)
+	{
+		ABaseGizmo* gizmo = SpawnGizmo(GizmoClass);
+		if (!gizmo) break;
+		FreeGizmos.Add(gizmo);
+	}
+}
+
+ABaseGizmo* UGizmoPoolSubsystem::LeaseGizmo(TSubclassOf<ABaseGizmo> GizmoClass)
+{
+	if (!GizmoClass) return nullptr;
+
+	RemoveInvalidGizmos();
+
+	ABaseGizmo* gizmo = nullptr;
+	const int32 index = FreeGizmos.IndexOfByPredicate([&GizmoClass](const ABaseGizmo* FreeGizmo)
+		{
+			return FreeGizmo->GetClass() == GizmoClass;
+		});
+
+	if (index != INDEX_NONE)
+	{
+		gizmo = FreeGizmos[index];
+		FreeGizmos.RemoveAtSwap(index);
+	}
+	else
+	{
+		gizmo = SpawnGizmo(GizmoClass);
+		if (!gizmo) return nullptr;
+	}
+
+	gizmo->SetActorHiddenInGame(false);
+	gizmo->SetActorTickEnabled(true);
+	gizmo->SetActorEnableCollision(true);
+
+	LeasedGizmos.Add(gizmo);
+	return gizmo;
+}
+
+void UGizmoPoolSubsystem::ReleaseGizmo(ABaseGizmo* Gizmo)
+{
+	if (!LeasedGizmos.RemoveSingleSwap(Gizmo)) return;
+	if (!IsValid(Gizmo))
+	{
+		DEC_DWORD_STAT(STAT_RTT_PooledGizmos);
+		return;
+	}
+
+	Gizmo->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Gizmo->SetActorHiddenInGame(true);
+	Gizmo->SetActorTickEnabled(false);
+	Gizmo->SetActorEnableCollision(false);
+	Gizmo->SetTransformProgressState(false, ETransformationDomain::TD_None);
+
+	FreeGizmos.Add(Gizmo);
+}
+
+ABaseGizmo* UGizmoPoolSubsystem::SpawnGizmo(UClass* GizmoClass)
+{
+	UWorld* world = GetWorld();
+	if (!world) return nullptr;
+
+	ABaseGizmo* gizmo = world->SpawnActor<ABaseGizmo>(GizmoClass);
+	ensureMsgf(gizmo, TEXT("Gizmo of class %s could not be created!"), *GetNameSafe(GizmoClass));
+	if (!gizmo) return nullptr;
+
+	gizmo->SetActorHiddenInGame(true);
+	gizmo->SetActorTickEnabled(false);
+	gizmo->SetActorEnableCollision(false);
+
+	INC_DWORD_STAT(STAT_RTT_PooledGizmos);
+	return gizmo;
+}
+
+void UGizmoPoolSubsystem::RemoveInvalidGizmos()
+{
+	const int32 numRemoved = FreeGizmos.RemoveAllSwap([](const ABaseGizmo* Gizmo) { return !IsValid(Gizmo); });
+	DEC_DWORD_STAT_BY(STAT_RTT_PooledGizmos, numRemoved);
+}
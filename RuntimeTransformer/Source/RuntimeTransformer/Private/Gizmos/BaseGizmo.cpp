@@ -5,8 +5,12 @@
 #include "Components/SceneComponent.h"
 #include "Components/ShapeComponent.h"
 #include "Components/BoxComponent.h"
+#include "Components/SphereComponent.h"
+#include "Components/CapsuleComponent.h"
 #include "Engine/World.h"
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gizmo Component Updates"), STAT_RTT_GizmoComponentUpdates, STATGROUP_RuntimeTransformer);
+
 // Sets default values
 ABaseGizmo::ABaseGizmo()
 {
@@ -30,16 +34,24 @@ ABaseGizmo::ABaseGizmo()
 
 	GizmoSceneScaleFactor = 0.1f;
 	CameraArcRadius = 150.f;
+	SceneScaleTolerance = 0.01f;
 
 	PreviousRayStartPoint = FVector::ZeroVector;
 	PreviousRayEndPoint = FVector::ZeroVector;
 
 	bTransformInProgress = false;
 	bIsPrevRayValid = false;
+
+	NumActorSceneComponents = INDEX_NONE;
+	NumScalingSceneComponents = INDEX_NONE;
 }
 
 void ABaseGizmo::UpdateGizmoSpace(ESpaceType SpaceType)
 {
+#if STATS
+	const FQuat previousRotation = GetActorQuat();
+#endif
+
 	switch (SpaceType)
 	{
 	case ESpaceType::ST_Local:
@@ -49,6 +61,12 @@ void ABaseGizmo::UpdateGizmoSpace(ESpaceType SpaceType)
 		SetActorRotation(FQuat(EForceInit::ForceInit), ETeleportType::TeleportPhysics);
 		break;
 	}
+
+#if STATS
+	//Rotation is only propagated when it actually changes
+	if (!GetActorQuat().Equals(previousRotation, 0.0))
+		INC_DWORD_STAT_BY(STAT_RTT_GizmoComponentUpdates, GetNumComponentsToUpdate(false));
+#endif
 }
 
 //Base Gizmo does not affect anything and returns No Delta Transform.
@@ -65,10 +83,21 @@ FTransform ABaseGizmo::GetDeltaTransform(const FVector& LookingVector
 
 void ABaseGizmo::ScaleGizmoScene(const FVector& ReferenceLocation, const FVector& ReferenceLookDirection, float FieldOfView)
 {
+	if (!ScalingScene) return;
+
 	FVector Scale = CalculateGizmoSceneScale(ReferenceLocation, ReferenceLookDirection, FieldOfView);
 	//UE_LOG(LogRuntimeTransformer, Warning, TEXT("Scale: %s"), *Scale.ToString());
-	if (ScalingScene)
-		ScalingScene->SetWorldScale3D(Scale);
+
+	//Small changes are not noticeable on screen, but would update every Component under the Scaling Scene
+	//Sign flips (Rotation Gizmo facing the Camera) are always bigger than the tolerance
+	const FVector currentScale = ScalingScene->GetComponentScale();
+	const FVector tolerance = currentScale.GetAbs() * SceneScaleTolerance;
+	const FVector difference = (Scale - currentScale).GetAbs();
+	if (difference.X <= tolerance.X && difference.Y <= tolerance.Y && difference.Z <= tolerance.Z)
+		return;
+
+	ScalingScene->SetWorldScale3D(Scale);
+	INC_DWORD_STAT_BY(STAT_RTT_GizmoComponentUpdates, GetNumComponentsToUpdate(true));
 }
 
 FTransform ABaseGizmo::GetSnappedTransform(FTransform& outCurrentAccumulatedTransform
@@ -94,6 +123,134 @@ ETransformationDomain ABaseGizmo::GetTransformationDomain(USceneComponent* Compo
 	return ETransformationDomain::TD_None;
 }
 
+// Smallest T where the Segment (Start + T * Delta) enters the Sphere, or -1 if it misses it
+static float SegmentSphereIntersection(const FVector& Start, const FVector& Delta, const FVector& Center, float Radius)
+{
+	const FVector toStart = Start - Center;
+	const double a = Delta.SizeSquared();
+	const double b = 2.0 * FVector::DotProduct(toStart, Delta);
+	const double c = toStart.SizeSquared() - Radius * Radius;
+	const double discriminant = b * b - 4.0 * a * c;
+	if (a <= UE_SMALL_NUMBER || discriminant < 0.0) return -1.f;
+	return (-b - FMath::Sqrt(discriminant)) / (2.0 * a);
+}
+
+// Segment (in Component Space, Start + T * Delta with T in [0, 1]) against a Capsule aligned on the Z Axis. Returns the closest T or -1.
+static float SegmentCapsuleIntersection(const FVector& Start, const FVector& Delta, float Radius, float HalfHeight)
+{
+	const float halfSegment = FMath::Max(HalfHeight - Radius, 0.f);
+
+	float closestTime = -1.f;
+	auto consider = [&closestTime](float Time)
+		{
+			if (Time >= 0.f && Time <= 1.f && (closestTime < 0.f || Time < closestTime))
+				closestTime = Time;
+		};
+
+	//Cylinder body (infinite cylinder clipped to the segment between both hemisphere centers)
+	const double a = Delta.X * Delta.X + Delta.Y * Delta.Y;
+	if (a > UE_SMALL_NUMBER)
+	{
+		const double b = 2.0 * (Start.X * Delta.X + Start.Y * Delta.Y);
+		const double c = Start.X * Start.X + Start.Y * Start.Y - Radius * Radius;
+		const double discriminant = b * b - 4.0 * a * c;
+		if (discriminant >= 0.0)
+		{
+			const float time = (-b - FMath::Sqrt(discriminant)) / (2.0 * a);
+			if (FMath::Abs(Start.Z + time * Delta.Z) <= halfSegment)
+				consider(time);
+		}
+	}
+
+	//Hemisphere caps
+	for (const float capZ : { halfSegment, -halfSegment })
+	{
+		consider(SegmentSphereIntersection(Start, Delta, FVector(0.f, 0.f, capZ), Radius));
+	}
+
+	//Starting inside counts as a hit at the start
+	const FVector closestOnAxis(0.f, 0.f, FMath::Clamp(Start.Z, -halfSegment, halfSegment));
+	if (FVector::DistSquared(Start, closestOnAxis) <= Radius * Radius)
+		closestTime = 0.f;
+
+	return closestTime;
+}
+
+ETransformationDomain ABaseGizmo::TraceTransformationDomain(const FVector& RayStartPoint, const FVector& RayEndPoint
+	, float& OutHitDistance) const
+{
+	ETransformationDomain closestDomain = ETransformationDomain::TD_None;
+	float closestTime = BIG_NUMBER;
+
+	if (IsHidden()) return closestDomain;
+
+	for (const TPair<UShapeComponent*, ETransformationDomain>& domainEntry : DomainMap)
+	{
+		const UShapeComponent* shape = domainEntry.Key;
+		//hidden shapes and shapes with their own collision disabled are not picked (as with the physics trace).
+		//The Actor's collision is not checked: it is off when the Gizmo is only picked analytically (see bGizmoCollision)
+		if (!shape || !shape->IsVisible() || shape->BodyInstance.GetCollisionEnabled(false) == ECollisionEnabled::NoCollision) continue;
+
+		//Component Space makes every shape axis aligned, centered and unscaled
+		const FTransform& componentTransform = shape->GetComponentTransform();
+		const FVector localStart = componentTransform.InverseTransformPosition(RayStartPoint);
+		const FVector localEnd = componentTransform.InverseTransformPosition(RayEndPoint);
+
+		float time = -1.f;
+		if (const UBoxComponent* box = Cast<UBoxComponent>(shape))
+		{
+			const FVector extent = box->GetUnscaledBoxExtent();
+			FVector hitLocation, hitNormal;
+			if (!FMath::LineExtentBoxIntersection(FBox(-extent, extent), localStart, localEnd, FVector::ZeroVector
+				, hitLocation, hitNormal, time))
+				time = -1.f;
+		}
+		else if (const USphereComponent* sphere = Cast<USphereComponent>(shape))
+		{
+			time = SegmentCapsuleIntersection(localStart, localEnd - localStart, sphere->GetUnscaledSphereRadius(), 0.f);
+		}
+		else if (const UCapsuleComponent* capsule = Cast<UCapsuleComponent>(shape))
+		{
+			time = SegmentCapsuleIntersection(localStart, localEnd - localStart
+				, capsule->GetUnscaledCapsuleRadius(), capsule->GetUnscaledCapsuleHalfHeight());
+		}
+
+		if (time >= 0.f && time < closestTime)
+		{
+			closestTime = time;
+			closestDomain = domainEntry.Value;
+		}
+	}
+
+	for (const FDomainRing& ring : DomainRings)
+	{
+		const USceneComponent* component = ring.Component.Get();
+		if (!component || !component->IsVisible()) continue;
+
+		const FTransform& componentTransform = component->GetComponentTransform();
+		const FVector localStart = componentTransform.InverseTransformPosition(RayStartPoint);
+		const FVector localEnd = componentTransform.InverseTransformPosition(RayEndPoint);
+
+		//the Ring lies on the local XY Plane
+		const float deltaZ = localEnd.Z - localStart.Z;
+		if (FMath::IsNearlyZero(deltaZ)) continue;
+
+		const float time = -localStart.Z / deltaZ;
+		if (time < 0.f || time > 1.f || time >= closestTime) continue;
+
+		const float radius = FVector2D(FMath::Lerp(localStart, localEnd, time)).Size();
+		if (radius >= ring.InnerRadius && radius <= ring.OuterRadius)
+		{
+			closestTime = time;
+			closestDomain = ring.Domain;
+		}
+	}
+
+	OutHitDistance = closestDomain != ETransformationDomain::TD_None
+		? closestTime * FVector::Dist(RayStartPoint, RayEndPoint) : 0.f;
+	return closestDomain;
+}
+
 FVector ABaseGizmo::CalculateGizmoSceneScale(const FVector& ReferenceLocation, const FVector& ReferenceLookDirection, float FieldOfView)
 {
 	FVector deltaLocation = (GetActorLocation() - ReferenceLocation);
@@ -103,6 +260,21 @@ FVector ABaseGizmo::CalculateGizmoSceneScale(const FVector& ReferenceLocation, c
 	return FVector(scaleView);
 }
 
+int32 ABaseGizmo::GetNumComponentsToUpdate(bool bScalingSceneOnly)
+{
+	if (NumActorSceneComponents == INDEX_NONE)
+	{
+		TArray<USceneComponent*> children;
+		RootScene->GetChildrenComponents(true, children);
+		NumActorSceneComponents = children.Num() + 1;
+
+		children.Reset();
+		ScalingScene->GetChildrenComponents(true, children);
+		NumScalingSceneComponents = children.Num() + 1;
+	}
+	return bScalingSceneOnly ? NumScalingSceneComponents : NumActorSceneComponents;
+}
+
 bool ABaseGizmo::AreRaysValid() const
 {
 	return bIsPrevRayValid;
@@ -126,6 +298,21 @@ void ABaseGizmo::RegisterDomainComponent(USceneComponent* Component
 		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Failed to Register Component! Component is not a Shape Component %s"), *Component->GetName());
 }
 
+void ABaseGizmo::RegisterDomainRing(USceneComponent* Component
+	, ETransformationDomain Domain, float InnerRadius, float OuterRadius)
+{
+	if (!Component) return;
+
+	FDomainRing* ring = DomainRings.FindByPredicate([Component](const FDomainRing& Ring) { return Ring.Component == Component; });
+	if (!ring)
+		ring = &DomainRings.AddDefaulted_GetRef();
+
+	ring->Component = Component;
+	ring->Domain = Domain;
+	ring->InnerRadius = FMath::Min(InnerRadius, OuterRadius);
+	ring->OuterRadius = FMath::Max(InnerRadius, OuterRadius);
+}
+
 void ABaseGizmo::SetTransformProgressState(bool bInProgress
 	, ETransformationDomain CurrentDomain)
 {
@@ -1,12 +1,42 @@
 // Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
 
 #include "Gizmos/RotationGizmo.h"
+#include "Components/SceneComponent.h"
 
 ARotationGizmo::ARotationGizmo()
 {
+	X_AxisRing = CreateDefaultSubobject<USceneComponent>(TEXT("X Axis Ring"));
+	Y_AxisRing = CreateDefaultSubobject<USceneComponent>(TEXT("Y Axis Ring"));
+	Z_AxisRing = CreateDefaultSubobject<USceneComponent>(TEXT("Z Axis Ring"));
+
+	X_AxisRing->SetupAttachment(ScalingScene);
+	Y_AxisRing->SetupAttachment(ScalingScene);
+	Z_AxisRing->SetupAttachment(ScalingScene);
+
+	//the Ring lies on the XY Plane of its Component, so its Z Axis is turned to the Rotation Axis
+	X_AxisRing->SetRelativeRotation(FRotator(90.f, 0.f, 0.f));
+	Y_AxisRing->SetRelativeRotation(FRotator(0.f, 0.f, 90.f));
+
+	RingInnerRadius = 60.f;
+	RingOuterRadius = 80.f;
+
+	RegisterDomainRing(X_AxisRing, ETransformationDomain::TD_X_Axis, RingInnerRadius, RingOuterRadius);
+	RegisterDomainRing(Y_AxisRing, ETransformationDomain::TD_Y_Axis, RingInnerRadius, RingOuterRadius);
+	RegisterDomainRing(Z_AxisRing, ETransformationDomain::TD_Z_Axis, RingInnerRadius, RingOuterRadius);
+
 	PreviousRotationViewScale = FVector::OneVector;
 }
 
+void ARotationGizmo::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	//the Radii could have been changed in a Blueprint subclass after the constructor registered the Rings
+	RegisterDomainRing(X_AxisRing, ETransformationDomain::TD_X_Axis, RingInnerRadius, RingOuterRadius);
+	RegisterDomainRing(Y_AxisRing, ETransformationDomain::TD_Y_Axis, RingInnerRadius, RingOuterRadius);
+	RegisterDomainRing(Z_AxisRing, ETransformationDomain::TD_Z_Axis, RingInnerRadius, RingOuterRadius);
+}
+
 FVector ARotationGizmo::CalculateGizmoSceneScale(const FVector& ReferenceLocation
 	, const FVector& ReferenceLookDirection, float FieldOfView)
 {
@@ -16,12 +46,14 @@ FVector ARotationGizmo::CalculateGizmoSceneScale(const FVector& ReferenceLocatio
 	bool bInProgress = GetTransformProgressState();
 	if (!bInProgress)
 	{
-		FVector deltaLocation = ReferenceLocation - GetActorLocation();
+		const FTransform& actorTransform = GetActorTransform();
+		//Unrotating gives the Dot Products with the Forward, Right and Up Vectors in a single operation
+		FVector localDeltaLocation = actorTransform.GetRotation().UnrotateVector(ReferenceLocation - actorTransform.GetLocation());
 	
 		currentRotationViewScale = FVector(
-			(FVector::DotProduct(GetActorForwardVector(), deltaLocation)	>= 0) ? 1.f : -1.f,
-			(FVector::DotProduct(GetActorRightVector()	, deltaLocation)	>= 0) ? 1.f : -1.f,
-			(FVector::DotProduct(GetActorUpVector()		, deltaLocation)	>= 0) ? 1.f : -1.f
+			(localDeltaLocation.X >= 0) ? 1.f : -1.f,
+			(localDeltaLocation.Y >= 0) ? 1.f : -1.f,
+			(localDeltaLocation.Z >= 0) ? 1.f : -1.f
 		);
 
 		PreviousRotationViewScale = currentRotationViewScale;
@@ -0,0 +1,158 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "MeshPickingSubsystem.h"
+#include "MeshTriangleBVH.h"
+#include "RuntimeTransformer.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "PhysicsEngine/BodySetup.h"
+
+DECLARE_CYCLE_STAT(TEXT("Mesh BVH Build"), STAT_RTT_MeshBVHBuild, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Mesh BVH Pick"), STAT_RTT_MeshBVHPick, STATGROUP_RuntimeTransformer);
+DECLARE_MEMORY_STAT(TEXT("Mesh BVH Memory"), STAT_RTT_MeshBVHMemory, STATGROUP_RuntimeTransformer);
+
+void UMeshPickingSubsystem::Deinitialize()
+{
+	EmptyCache();
+	Super::Deinitialize();
+}
+
+bool UMeshPickingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UMeshPickingSubsystem::EmptyCache()
+{
+	DEC_MEMORY_STAT_BY(STAT_RTT_MeshBVHMemory, CachedMemory);
+	CachedMeshes.Empty();
+	CachedMemory = 0;
+}
+
+TSharedPtr<const FMeshTriangleBVH> UMeshPickingSubsystem::FindOrBuildBVH(const UStaticMesh* Mesh)
+{
+	if (!Mesh) return nullptr;
+
+	const void* renderData = Mesh->GetRenderData();
+	FCachedMesh* cachedMesh = CachedMeshes.Find(Mesh);
+	if (cachedMesh && cachedMesh->RenderData == renderData && !cachedMesh->bRetry)
+		return cachedMesh->BVH;
+
+	if (!cachedMesh)
+		cachedMesh = &CachedMeshes.Add(Mesh);
+	else if (cachedMesh->BVH)
+	{
+		const SIZE_T oldSize = cachedMesh->BVH->GetAllocatedSize();
+		CachedMemory -= oldSize;
+		DEC_MEMORY_STAT_BY(STAT_RTT_MeshBVHMemory, oldSize);
+	}
+
+	cachedMesh->BVH = BuildBVH(Mesh, cachedMesh->bRetry);
+	cachedMesh->RenderData = renderData;
+
+	if (cachedMesh->BVH)
+	{
+		const SIZE_T size = cachedMesh->BVH->GetAllocatedSize();
+		CachedMemory += size;
+		INC_MEMORY_STAT_BY(STAT_RTT_MeshBVHMemory, size);
+	}
+	return cachedMesh->BVH;
+}
+
+TSharedPtr<const FMeshTriangleBVH> UMeshPickingSubsystem::BuildBVH(const UStaticMesh* Mesh, bool& bOutRetry) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTT_MeshBVHBuild);
+
+	//missing / empty Render Data can still be streamed in
+	bOutRetry = true;
+
+	const FStaticMeshRenderData* renderData = Mesh->GetRenderData();
+	if (!renderData || renderData->LODResources.Num() == 0) return nullptr;
+
+#if !WITH_EDITOR
+	//without CPU Access the Vertex and Index data is discarded once uploaded to the GPU
+	if (!Mesh->bAllowCPUAccess)
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Static Mesh [%s] can't be picked by Triangle as it does NOT Allow CPU Access!"), *Mesh->GetName());
+		bOutRetry = false;
+		return nullptr;
+	}
+#endif
+
+	const double startTime = FPlatformTime::Seconds();
+
+	const FStaticMeshLODResources& lod = renderData->LODResources[0];
+	const FPositionVertexBuffer& positionBuffer = lod.VertexBuffers.PositionVertexBuffer;
+
+	TArray<uint32> indices;
+	lod.IndexBuffer.GetCopy(indices);
+	if (indices.Num() < 3 || positionBuffer.GetNumVertices() == 0) return nullptr;
+
+	TArray<FVector3f> vertices;
+	vertices.SetNumUninitialized(positionBuffer.GetNumVertices());
+	for (uint32 i = 0; i < positionBuffer.GetNumVertices(); ++i)
+		vertices[i] = positionBuffer.VertexPosition(i);
+
+	TSharedPtr<const FMeshTriangleBVH> bvh = MakeShared<FMeshTriangleBVH>(MoveTemp(vertices), indices);
+	bOutRetry = false;
+
+	//Complex Collision size, to compare against what Triangle picking costs
+	SIZE_T collisionSize = 0;
+	if (UBodySetup* bodySetup = Mesh->GetBodySetup())
+	{
+		FResourceSizeEx resourceSize(EResourceSizeMode::Exclusive);
+		bodySetup->GetResourceSizeEx(resourceSize);
+		collisionSize = resourceSize.GetTotalMemoryBytes();
+	}
+
+	UE_LOG(LogRuntimeTransformer, Verbose, TEXT("Built Triangle BVH of [%s]: %d Triangles, %.1f KB (Collision: %.1f KB) in %.2f ms")
+		, *Mesh->GetName(), bvh->GetNumTriangles(), bvh->GetAllocatedSize() / 1024.0, collisionSize / 1024.0
+		, (FPlatformTime::Seconds() - startTime) * 1000.0);
+
+	return bvh;
+}
+
+EMeshPickResult UMeshPickingSubsystem::RefineHit(FHitResult& InOutHit)
+{
+	const UStaticMeshComponent* meshComponent = Cast<UStaticMeshComponent>(InOutHit.GetComponent());
+	if (!meshComponent) return EMeshPickResult::NoMeshData;
+
+	TSharedPtr<const FMeshTriangleBVH> bvh = FindOrBuildBVH(meshComponent->GetStaticMesh());
+	if (!bvh) return EMeshPickResult::NoMeshData;
+
+	SCOPE_CYCLE_COUNTER(STAT_RTT_MeshBVHPick);
+
+	FTransform meshTransform = meshComponent->GetComponentTransform();
+	if (const UInstancedStaticMeshComponent* instancedComponent = Cast<UInstancedStaticMeshComponent>(meshComponent))
+	{
+		if (!instancedComponent->GetInstanceTransform(InOutHit.Item, meshTransform, true))
+			return EMeshPickResult::NoMeshData;
+	}
+
+	//Time along the Trace is the same in Mesh space, as the Transform is affine
+	const FVector traceStart = InOutHit.TraceStart;
+	const FVector traceEnd = InOutHit.TraceEnd;
+	const FVector3f localStart(meshTransform.InverseTransformPosition(traceStart));
+	const FVector3f localEnd(meshTransform.InverseTransformPosition(traceEnd));
+
+	FMeshTriangleHit triangleHit;
+	if (!bvh->Raycast(localStart, localEnd - localStart, triangleHit))
+		return EMeshPickResult::Miss;
+
+	//Normal of the World Space Triangle, so non-uniform (and negative) Scales are handled
+	const FVector a = meshTransform.TransformPosition(FVector(triangleHit.A));
+	const FVector b = meshTransform.TransformPosition(FVector(triangleHit.B));
+	const FVector c = meshTransform.TransformPosition(FVector(triangleHit.C));
+	FVector normal = FVector::CrossProduct(c - a, b - a).GetSafeNormal();
+	if (FVector::DotProduct(normal, traceEnd - traceStart) > 0.0)
+		normal = -normal; //facing the Trace
+
+	InOutHit.Time = triangleHit.Time;
+	InOutHit.Location = InOutHit.ImpactPoint = traceStart + (traceEnd - traceStart) * triangleHit.Time;
+	InOutHit.Distance = FVector::Dist(traceStart, InOutHit.Location);
+	InOutHit.Normal = InOutHit.ImpactNormal = normal;
+	InOutHit.FaceIndex = triangleHit.TriangleIndex;
+	return EMeshPickResult::Hit;
+}
@@ -0,0 +1,203 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "MeshTriangleBVH.h"
+
+namespace
+{
+	// Max Triangles per leaf
+	const int32 MaxLeafTriangles = 4;
+}
+
+FMeshTriangleBVH::FMeshTriangleBVH(TArray<FVector3f>&& InVertices, const TArray<uint32>& InIndices)
+	: Vertices(MoveTemp(InVertices))
+	, Indices(InIndices)
+{
+	const int32 numTriangles = Indices.Num() / 3;
+	Indices.SetNum(numTriangles * 3);
+
+	TriangleIds.SetNumUninitialized(numTriangles);
+	TArray<FVector3f> centroids;
+	centroids.SetNumUninitialized(numTriangles);
+	for (int32 i = 0; i < numTriangles; ++i)
+	{
+		TriangleIds[i] = i;
+		centroids[i] = (Vertices[Indices[i * 3]] + Vertices[Indices[i * 3 + 1]] + Vertices[Indices[i * 3 + 2]]) / 3.f;
+	}
+
+	if (numTriangles > 0)
+	{
+		//a binary tree with N / MaxLeafTriangles leaves has less than twice as many nodes
+		Nodes.Reserve(2 * FMath::DivideAndRoundUp(numTriangles, MaxLeafTriangles));
+		BuildNode(centroids, 0, numTriangles);
+	}
+	Nodes.Shrink();
+}
+
+SIZE_T FMeshTriangleBVH::GetAllocatedSize() const
+{
+	return Vertices.GetAllocatedSize() + Indices.GetAllocatedSize() + TriangleIds.GetAllocatedSize() + Nodes.GetAllocatedSize();
+}
+
+int32 FMeshTriangleBVH::BuildNode(TArray<FVector3f>& Centroids, int32 First, int32 Count)
+{
+	const int32 nodeIndex = Nodes.AddUninitialized();
+
+	FBox3f bounds(ForceInit);
+	FBox3f centroidBounds(ForceInit);
+	for (int32 i = First; i < First + Count; ++i)
+	{
+		bounds += Vertices[Indices[i * 3]];
+		bounds += Vertices[Indices[i * 3 + 1]];
+		bounds += Vertices[Indices[i * 3 + 2]];
+		centroidBounds += Centroids[i];
+	}
+
+	Nodes[nodeIndex].Min = bounds.Min;
+	Nodes[nodeIndex].Max = bounds.Max;
+
+	const FVector3f centroidSize = centroidBounds.GetSize();
+	const int32 axis = centroidSize.X > centroidSize.Y
+		? (centroidSize.X > centroidSize.Z ? 0 : 2)
+		: (centroidSize.Y > centroidSize.Z ? 1 : 2);
+
+	//all Centroids at the same place can't be split
+	if (Count <= MaxLeafTriangles || centroidSize[axis] <= UE_KINDA_SMALL_NUMBER)
+	{
+		Nodes[nodeIndex].ChildOrFirstTriangle = First;
+		Nodes[nodeIndex].NumTriangles = Count;
+		return nodeIndex;
+	}
+
+	//Median split on the longest axis: sort the Triangles (with their Centroids and Ids) along it and split them in halves
+	const int32 middle = First + Count / 2;
+	{
+		TArray<int32> order;
+		order.SetNumUninitialized(Count);
+		for (int32 i = 0; i < Count; ++i)
+			order[i] = First + i;
+
+		order.Sort([&Centroids, axis](int32 A, int32 B) { return Centroids[A][axis] < Centroids[B][axis]; });
+
+		TArray<uint32> indices;
+		TArray<int32> ids;
+		TArray<FVector3f> centroids;
+		indices.SetNumUninitialized(Count * 3);
+		ids.SetNumUninitialized(Count);
+		centroids.SetNumUninitialized(Count);
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const int32 source = order[i];
+			indices[i * 3] = Indices[source * 3];
+			indices[i * 3 + 1] = Indices[source * 3 + 1];
+			indices[i * 3 + 2] = Indices[source * 3 + 2];
+			ids[i] = TriangleIds[source];
+			centroids[i] = Centroids[source];
+		}
+		FMemory::Memcpy(&Indices[First * 3], indices.GetData(), indices.Num() * indices.GetTypeSize());
+		FMemory::Memcpy(&TriangleIds[First], ids.GetData(), ids.Num() * ids.GetTypeSize());
+		FMemory::Memcpy(&Centroids[First], centroids.GetData(), centroids.Num() * centroids.GetTypeSize());
+	}
+
+	BuildNode(Centroids, First, middle - First);
+	const int32 secondChild = BuildNode(Centroids, middle, First + Count - middle);
+
+	//Nodes may have been reallocated by the children
+	Nodes[nodeIndex].ChildOrFirstTriangle = secondChild;
+	Nodes[nodeIndex].NumTriangles = 0;
+	return nodeIndex;
+}
+
+bool FMeshTriangleBVH::RaycastTriangle(int32 Triangle, const FVector3f& Start, const FVector3f& Direction, float& InOutTime) const
+{
+	//Moller-Trumbore, without culling back faces
+	const FVector3f& a = Vertices[Indices[Triangle * 3]];
+	const FVector3f edge1 = Vertices[Indices[Triangle * 3 + 1]] - a;
+	const FVector3f edge2 = Vertices[Indices[Triangle * 3 + 2]] - a;
+
+	const FVector3f p = FVector3f::CrossProduct(Direction, edge2);
+	const float determinant = FVector3f::DotProduct(edge1, p);
+	if (FMath::Abs(determinant) <= UE_SMALL_NUMBER) return false; //parallel
+
+	const float invDeterminant = 1.f / determinant;
+	const FVector3f s = Start - a;
+	const float u = FVector3f::DotProduct(s, p) * invDeterminant;
+	if (u < 0.f || u > 1.f) return false;
+
+	const FVector3f q = FVector3f::CrossProduct(s, edge1);
+	const float v = FVector3f::DotProduct(Direction, q) * invDeterminant;
+	if (v < 0.f || u + v > 1.f) return false;
+
+	const float time = FVector3f::DotProduct(edge2, q) * invDeterminant;
+	if (time < 0.f || time >= InOutTime) return false;
+
+	InOutTime = time;
+	return true;
+}
+
+bool FMeshTriangleBVH::Raycast(const FVector3f& Start, const FVector3f& Direction, FMeshTriangleHit& OutHit) const
+{
+	if (Nodes.Num() == 0) return false;
+
+	//Reciprocal of the Direction for the Slab Tests (an infinite reciprocal makes a parallel axis never clip the Ray)
+	const FVector3f invDirection(
+		Direction.X != 0.f ? 1.f / Direction.X : UE_BIG_NUMBER,
+		Direction.Y != 0.f ? 1.f / Direction.Y : UE_BIG_NUMBER,
+		Direction.Z != 0.f ? 1.f / Direction.Z : UE_BIG_NUMBER);
+
+	//Time at which the Ray enters the Node, or a value past the closest hit if it misses it
+	auto enterTime = [&](const FNode& Node, float MaxTime)
+		{
+			const FVector3f t0 = (Node.Min - Start) * invDirection;
+			const FVector3f t1 = (Node.Max - Start) * invDirection;
+			const float tEnter = FMath::Max3(FMath::Min(t0.X, t1.X), FMath::Min(t0.Y, t1.Y), FMath::Min(t0.Z, t1.Z));
+			const float tExit = FMath::Min3(FMath::Max(t0.X, t1.X), FMath::Max(t0.Y, t1.Y), FMath::Max(t0.Z, t1.Z));
+			return (tExit >= FMath::Max(tEnter, 0.f) && tEnter <= MaxTime) ? tEnter : UE_BIG_NUMBER;
+		};
+
+	float closestTime = 1.f;
+	int32 closestTriangle = INDEX_NONE;
+
+	TArray<int32, TInlineAllocator<64>> stack;
+	if (enterTime(Nodes[0], closestTime) <= closestTime)
+		stack.Add(0);
+
+	while (stack.Num() > 0)
+	{
+		const int32 nodeIndex = stack.Pop(EAllowShrinking::No);
+		const FNode& node = Nodes[nodeIndex];
+		if (node.NumTriangles > 0)
+		{
+			for (int32 i = node.ChildOrFirstTriangle; i < node.ChildOrFirstTriangle + node.NumTriangles; ++i)
+				if (RaycastTriangle(i, Start, Direction, closestTime))
+					closestTriangle = i;
+			continue;
+		}
+
+		//Visit the closest child first (pushed last), so the farther one is usually culled by the closest hit
+		const int32 first = nodeIndex + 1;
+		const int32 second = node.ChildOrFirstTriangle;
+		const float firstTime = enterTime(Nodes[first], closestTime);
+		const float secondTime = enterTime(Nodes[second], closestTime);
+
+		if (firstTime <= secondTime)
+		{
+			if (secondTime <= closestTime) stack.Add(second);
+			if (firstTime <= closestTime) stack.Add(first);
+		}
+		else
+		{
+			if (firstTime <= closestTime) stack.Add(first);
+			if (secondTime <= closestTime) stack.Add(second);
+		}
+	}
+
+	if (closestTriangle == INDEX_NONE) return false;
+
+	OutHit.Time = closestTime;
+	OutHit.TriangleIndex = TriangleIds[closestTriangle];
+	OutHit.A = Vertices[Indices[closestTriangle * 3]];
+	OutHit.B = Vertices[Indices[closestTriangle * 3 + 1]];
+	OutHit.C = Vertices[Indices[closestTriangle * 3 + 2]];
+	return true;
+}
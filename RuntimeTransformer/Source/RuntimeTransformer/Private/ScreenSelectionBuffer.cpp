@@ -0,0 +1,212 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "ScreenSelectionBuffer.h"
+#include "Components/PrimitiveComponent.h"
+#include "Async/ParallelFor.h"
+#include "SelectionVectorOps.h"
+
+namespace
+{
+	using RTTVectorOps::FScalarOps;
+	using RTTVectorOps::FVectorOps;
+
+	// The View Projection Matrix and View Rect broadcast to the lane width of Ops
+	template<typename Ops>
+	struct TProjectionConstants
+	{
+		typedef typename Ops::Type T;
+
+		// Columns 0 (Clip X), 1 (Clip Y) and 3 (Clip W) of the Matrix, as row vectors are multiplied by it
+		T X0, X1, X2, X3;
+		T Y0, Y1, Y2, Y3;
+		T W0, W1, W2, W3;
+
+		T HalfWidth, NegHalfHeight;		// NDC to pixels
+		T PixelCenterX, PixelCenterY;
+		T MinW;							// Clip W under which a point is considered behind the camera
+		T One, Big, NegBig;
+
+		TProjectionConstants(const FMatrix& M, const FIntRect& ViewRect)
+		{
+			X0 = Ops::Splat(M.M[0][0]); X1 = Ops::Splat(M.M[1][0]); X2 = Ops::Splat(M.M[2][0]); X3 = Ops::Splat(M.M[3][0]);
+			Y0 = Ops::Splat(M.M[0][1]); Y1 = Ops::Splat(M.M[1][1]); Y2 = Ops::Splat(M.M[2][1]); Y3 = Ops::Splat(M.M[3][1]);
+			W0 = Ops::Splat(M.M[0][3]); W1 = Ops::Splat(M.M[1][3]); W2 = Ops::Splat(M.M[2][3]); W3 = Ops::Splat(M.M[3][3]);
+
+			const double halfWidth = ViewRect.Width() * 0.5;
+			const double halfHeight = ViewRect.Height() * 0.5;
+			HalfWidth = Ops::Splat(halfWidth);
+			NegHalfHeight = Ops::Splat(-halfHeight);
+			PixelCenterX = Ops::Splat(ViewRect.Min.X + halfWidth);
+			PixelCenterY = Ops::Splat(ViewRect.Min.Y + halfHeight);
+
+			MinW = Ops::Splat(UE_KINDA_SMALL_NUMBER);
+			One = Ops::Splat(1.0);
+			Big = Ops::Splat(UE_BIG_NUMBER);
+			NegBig = Ops::Splat(-UE_BIG_NUMBER);
+		}
+	};
+
+	// Projects Ops::Width candidates starting at Index
+	template<typename Ops>
+	FORCEINLINE void ProjectLanes(FScreenSelectionBuffer& Buffer, int32 Index, const TProjectionConstants<Ops>& C)
+	{
+		typedef typename Ops::Type T;
+
+		const T cx = Ops::Load(&Buffer.CenterX[Index]);
+		const T cy = Ops::Load(&Buffer.CenterY[Index]);
+		const T cz = Ops::Load(&Buffer.CenterZ[Index]);
+		const T ex = Ops::Load(&Buffer.ExtentX[Index]);
+		const T ey = Ops::Load(&Buffer.ExtentY[Index]);
+		const T ez = Ops::Load(&Buffer.ExtentZ[Index]);
+
+		T minX = C.Big, minY = C.Big, maxX = C.NegBig, maxY = C.NegBig;
+		T minW = C.Big;
+
+		for (int32 corner = 0; corner < 8; ++corner)
+		{
+			const T x = (corner & 1) ? Ops::Add(cx, ex) : Ops::Sub(cx, ex);
+			const T y = (corner & 2) ? Ops::Add(cy, ey) : Ops::Sub(cy, ey);
+			const T z = (corner & 4) ? Ops::Add(cz, ez) : Ops::Sub(cz, ez);
+
+			const T clipX = Ops::MulAdd(x, C.X0, Ops::MulAdd(y, C.X1, Ops::MulAdd(z, C.X2, C.X3)));
+			const T clipY = Ops::MulAdd(x, C.Y0, Ops::MulAdd(y, C.Y1, Ops::MulAdd(z, C.Y2, C.Y3)));
+			const T clipW = Ops::MulAdd(x, C.W0, Ops::MulAdd(y, C.W1, Ops::MulAdd(z, C.W2, C.W3)));
+			minW = Ops::Min(minW, clipW);
+
+			//lanes with a corner behind the camera get discarded below, so their division does not matter
+			const T invW = Ops::Div(C.One, clipW);
+			const T ndcX = Ops::Mul(clipX, invW);
+			const T ndcY = Ops::Mul(clipY, invW);
+			minX = Ops::Min(minX, ndcX); maxX = Ops::Max(maxX, ndcX);
+			minY = Ops::Min(minY, ndcY); maxY = Ops::Max(maxY, ndcY);
+		}
+
+		//Screen Y goes down while NDC Y goes up
+		T screenMinX = Ops::MulAdd(minX, C.HalfWidth, C.PixelCenterX);
+		T screenMaxX = Ops::MulAdd(maxX, C.HalfWidth, C.PixelCenterX);
+		T screenMinY = Ops::MulAdd(maxY, C.NegHalfHeight, C.PixelCenterY);
+		T screenMaxY = Ops::MulAdd(minY, C.NegHalfHeight, C.PixelCenterY);
+
+		//Bounds crossing the camera plane: use the Center, if it is in front
+		const T centerClipX = Ops::MulAdd(cx, C.X0, Ops::MulAdd(cy, C.X1, Ops::MulAdd(cz, C.X2, C.X3)));
+		const T centerClipY = Ops::MulAdd(cx, C.Y0, Ops::MulAdd(cy, C.Y1, Ops::MulAdd(cz, C.Y2, C.Y3)));
+		const T centerClipW = Ops::MulAdd(cx, C.W0, Ops::MulAdd(cy, C.W1, Ops::MulAdd(cz, C.W2, C.W3)));
+		const T centerInvW = Ops::Div(C.One, centerClipW);
+		const T centerX = Ops::MulAdd(Ops::Mul(centerClipX, centerInvW), C.HalfWidth, C.PixelCenterX);
+		const T centerY = Ops::MulAdd(Ops::Mul(centerClipY, centerInvW), C.NegHalfHeight, C.PixelCenterY);
+
+		const typename Ops::MaskType bCornersInFront = Ops::CompareGT(minW, C.MinW);
+		const typename Ops::MaskType bCenterInFront = Ops::CompareGT(centerClipW, C.MinW);
+
+		screenMinX = Ops::Select(bCornersInFront, screenMinX, Ops::Select(bCenterInFront, centerX, C.Big));
+		screenMaxX = Ops::Select(bCornersInFront, screenMaxX, Ops::Select(bCenterInFront, centerX, C.NegBig));
+		screenMinY = Ops::Select(bCornersInFront, screenMinY, Ops::Select(bCenterInFront, centerY, C.Big));
+		screenMaxY = Ops::Select(bCornersInFront, screenMaxY, Ops::Select(bCenterInFront, centerY, C.NegBig));
+
+		Ops::Store(screenMinX, &Buffer.ScreenMinX[Index]);
+		Ops::Store(screenMaxX, &Buffer.ScreenMaxX[Index]);
+		Ops::Store(screenMinY, &Buffer.ScreenMinY[Index]);
+		Ops::Store(screenMaxY, &Buffer.ScreenMaxY[Index]);
+	}
+
+	// Projects the candidates in [Start, End)
+	void ProjectKernel(FScreenSelectionBuffer& Buffer, const FMatrix& ViewProjection, const FIntRect& ViewRect, int32 Start, int32 End)
+	{
+		const int32 VectorizedEnd = End - ((End - Start) % FVectorOps::Width);
+
+		const TProjectionConstants<FVectorOps> VectorConstants(ViewProjection, ViewRect);
+		for (int32 i = Start; i < VectorizedEnd; i += FVectorOps::Width)
+			ProjectLanes<FVectorOps>(Buffer, i, VectorConstants);
+
+		const TProjectionConstants<FScalarOps> ScalarConstants(ViewProjection, ViewRect);
+		for (int32 i = VectorizedEnd; i < End; ++i)
+			ProjectLanes<FScalarOps>(Buffer, i, ScalarConstants);
+	}
+
+	// Candidates per ParallelFor task. Multiple of the vector width so only the last task has a scalar tail
+	const int32 ProjectionBatchSize = 2048;
+}
+
+void FScreenSelectionBuffer::Reserve(int32 Number)
+{
+	Components.Reserve(Number);
+	CenterX.Reserve(Number); CenterY.Reserve(Number); CenterZ.Reserve(Number);
+	ExtentX.Reserve(Number); ExtentY.Reserve(Number); ExtentZ.Reserve(Number);
+	ScreenMinX.Reserve(Number); ScreenMinY.Reserve(Number); ScreenMaxX.Reserve(Number); ScreenMaxY.Reserve(Number);
+}
+
+void FScreenSelectionBuffer::Reset()
+{
+	Components.Reset();
+	CenterX.Reset(); CenterY.Reset(); CenterZ.Reset();
+	ExtentX.Reset(); ExtentY.Reset(); ExtentZ.Reset();
+	ScreenMinX.Reset(); ScreenMinY.Reset(); ScreenMaxX.Reset(); ScreenMaxY.Reset();
+}
+
+int32 FScreenSelectionBuffer::Add(UPrimitiveComponent* Component, const FBoxSphereBounds& Bounds)
+{
+	CenterX.Add(Bounds.Origin.X); CenterY.Add(Bounds.Origin.Y); CenterZ.Add(Bounds.Origin.Z);
+	ExtentX.Add(Bounds.BoxExtent.X); ExtentY.Add(Bounds.BoxExtent.Y); ExtentZ.Add(Bounds.BoxExtent.Z);
+	return Components.Add(Component);
+}
+
+void FScreenSelectionBuffer::Project(const FMatrix& ViewProjection, const FIntRect& ViewRect, bool bParallel)
+{
+	const int32 num = Num();
+	ScreenMinX.SetNumUninitialized(num); ScreenMinY.SetNumUninitialized(num);
+	ScreenMaxX.SetNumUninitialized(num); ScreenMaxY.SetNumUninitialized(num);
+
+	if (bParallel && num > ProjectionBatchSize)
+	{
+		const int32 numBatches = FMath::DivideAndRoundUp(num, ProjectionBatchSize);
+		ParallelFor(numBatches, [&](int32 Batch)
+		{
+			const int32 start = Batch * ProjectionBatchSize;
+			ProjectKernel(*this, ViewProjection, ViewRect, start, FMath::Min(start + ProjectionBatchSize, num));
+		});
+	}
+	else
+		ProjectKernel(*this, ViewProjection, ViewRect, 0, num);
+}
+
+void FScreenSelectionBuffer::GetInRect(const FBox2D& Rect, bool bRequireFullyInside, TArray<int32>& OutIndices) const
+{
+	for (int32 i = 0; i < Num(); ++i)
+	{
+		if (ScreenMinX[i] > ScreenMaxX[i]) continue; //not in front of the camera
+
+		const bool bInside = bRequireFullyInside
+			? ScreenMinX[i] >= Rect.Min.X && ScreenMaxX[i] <= Rect.Max.X && ScreenMinY[i] >= Rect.Min.Y && ScreenMaxY[i] <= Rect.Max.Y
+			: ScreenMinX[i] <= Rect.Max.X && ScreenMaxX[i] >= Rect.Min.X && ScreenMinY[i] <= Rect.Max.Y && ScreenMaxY[i] >= Rect.Min.Y;
+		if (bInside)
+			OutIndices.Add(i);
+	}
+}
+
+void FScreenSelectionBuffer::GetInPolygon(TConstArrayView<FVector2D> Polygon, TArray<int32>& OutIndices) const
+{
+	if (Polygon.Num() < 3) return;
+
+	const FBox2D polygonBounds(Polygon.GetData(), Polygon.Num());
+	for (int32 i = 0; i < Num(); ++i)
+	{
+		if (ScreenMinX[i] > ScreenMaxX[i]) continue; //not in front of the camera
+
+		const FVector2D point((ScreenMinX[i] + ScreenMaxX[i]) * 0.5, (ScreenMinY[i] + ScreenMaxY[i]) * 0.5);
+		if (!polygonBounds.IsInside(point)) continue;
+
+		//even-odd rule: count the edges crossed by a ray going right from the point
+		bool bInside = false;
+		for (int32 j = 0, k = Polygon.Num() - 1; j < Polygon.Num(); k = j++)
+		{
+			const FVector2D& a = Polygon[j];
+			const FVector2D& b = Polygon[k];
+			if ((a.Y > point.Y) != (b.Y > point.Y)
+				&& point.X < (b.X - a.X) * (point.Y - a.Y) / (b.Y - a.Y) + a.X)
+				bInside = !bInside;
+		}
+		if (bInside)
+			OutIndices.Add(i);
+	}
+}
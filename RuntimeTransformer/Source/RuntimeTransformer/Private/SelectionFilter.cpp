@@ -0,0 +1,166 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "SelectionFilter.h"
+#include "RuntimeTransformer.h"
+#include "GameFramework/Actor.h"
+#include "Components/SceneComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Selection Filter Class Cache Misses"), STAT_RTT_SelectionFilterCacheMisses, STATGROUP_RuntimeTransformer);
+
+namespace
+{
+	template<typename ClassType>
+	bool IsChildOfAny(const UClass* Class, const TArray<TSubclassOf<ClassType>>& Classes)
+	{
+		for (const TSubclassOf<ClassType>& c : Classes)
+			if (c && Class && Class->IsChildOf(c))
+				return true;
+		return false;
+	}
+
+	bool HasAnyTag(const AActor* OwnerActor, const USceneComponent* Component, const TArray<FName>& Tags)
+	{
+		for (const FName& tag : Tags)
+			if ((OwnerActor && OwnerActor->ActorHasTag(tag)) || (Component && Component->ComponentHasTag(tag)))
+				return true;
+		return false;
+	}
+}
+
+void FSelectionFilter::SetRules(const FSelectionFilterRules& InRules)
+{
+	Rules = InRules;
+	InvalidateCache();
+}
+
+int32 FSelectionFilter::AddClassRule(FClassRule Rule)
+{
+	const int32 ruleId = NextRuleId++;
+	ClassRules.Emplace(ruleId, MoveTemp(Rule));
+	InvalidateCache();
+	return ruleId;
+}
+
+int32 FSelectionFilter::AddInstanceRule(FInstanceRule Rule)
+{
+	const int32 ruleId = NextRuleId++;
+	InstanceRules.Emplace(ruleId, MoveTemp(Rule));
+	return ruleId;
+}
+
+bool FSelectionFilter::RemoveRule(int32 RuleId)
+{
+	auto hasId = [RuleId](const auto& Rule) { return Rule.Key == RuleId; };
+	if (ClassRules.RemoveAll(hasId) > 0)
+	{
+		InvalidateCache();
+		return true;
+	}
+	return InstanceRules.RemoveAll(hasId) > 0;
+}
+
+bool FSelectionFilter::IsEmpty() const
+{
+	return Rules.AllowedActorClasses.Num() == 0 && Rules.DeniedActorClasses.Num() == 0
+		&& Rules.AllowedComponentClasses.Num() == 0 && Rules.DeniedComponentClasses.Num() == 0
+		&& Rules.AllowedTags.Num() == 0 && Rules.DeniedTags.Num() == 0
+		&& ClassRules.Num() == 0 && InstanceRules.Num() == 0;
+}
+
+ESelectionFilterResult FSelectionFilter::EvaluateClasses(const UClass* ActorClass, const UClass* ComponentClass) const
+{
+	const TPair<TObjectKey<UClass>, TObjectKey<UClass>> key(ActorClass, ComponentClass);
+	if (const ESelectionFilterResult* cachedResult = ClassCache.Find(key))
+		return *cachedResult;
+
+	INC_DWORD_STAT(STAT_RTT_SelectionFilterCacheMisses);
+
+	ESelectionFilterResult result = ESelectionFilterResult::Undecided;
+	if (IsChildOfAny(ActorClass, Rules.DeniedActorClasses) || IsChildOfAny(ComponentClass, Rules.DeniedComponentClasses)
+		|| (Rules.AllowedActorClasses.Num() > 0 && !IsChildOfAny(ActorClass, Rules.AllowedActorClasses))
+		|| (Rules.AllowedComponentClasses.Num() > 0 && !IsChildOfAny(ComponentClass, Rules.AllowedComponentClasses)))
+		result = ESelectionFilterResult::Reject;
+	else
+	{
+		for (const TPair<int32, FClassRule>& rule : ClassRules)
+		{
+			result = rule.Value(ActorClass, ComponentClass);
+			if (result != ESelectionFilterResult::Undecided) break;
+		}
+	}
+
+	ClassCache.Add(key, result);
+	return result;
+}
+
+ESelectionFilterResult FSelectionFilter::EvaluateTags(const AActor* OwnerActor, const USceneComponent* Component) const
+{
+	if (HasAnyTag(OwnerActor, Component, Rules.DeniedTags))
+		return ESelectionFilterResult::Reject;
+	if (Rules.AllowedTags.Num() > 0 && !HasAnyTag(OwnerActor, Component, Rules.AllowedTags))
+		return ESelectionFilterResult::Reject;
+	return ESelectionFilterResult::Undecided;
+}
+
+ESelectionFilterResult FSelectionFilter::Evaluate(AActor* OwnerActor, USceneComponent* Component) const
+{
+	ESelectionFilterResult result = EvaluateClasses(OwnerActor ? OwnerActor->GetClass() : nullptr
+		, Component ? Component->GetClass() : nullptr);
+	if (result != ESelectionFilterResult::Undecided) return result;
+
+	result = EvaluateTags(OwnerActor, Component);
+	if (result != ESelectionFilterResult::Undecided) return result;
+
+	for (const TPair<int32, FInstanceRule>& rule : InstanceRules)
+	{
+		result = rule.Value(OwnerActor, Component);
+		if (result != ESelectionFilterResult::Undecided) break;
+	}
+	return result;
+}
+
+void FSelectionFilter::Evaluate(TConstArrayView<AActor*> OwnerActors, TConstArrayView<USceneComponent*> Components
+	, TArray<ESelectionFilterResult>& OutResults) const
+{
+	check(OwnerActors.Num() == Components.Num());
+	OutResults.SetNumUninitialized(Components.Num());
+
+	//candidates usually come in runs of the same classes, so the last class pair is remembered to skip the cache lookup
+	const UClass* lastActorClass = nullptr;
+	const UClass* lastComponentClass = nullptr;
+	ESelectionFilterResult lastClassResult = ESelectionFilterResult::Undecided;
+	bool bHasLastClass = false;
+
+	const bool bNoInstanceRules = Rules.AllowedTags.Num() == 0 && Rules.DeniedTags.Num() == 0 && InstanceRules.Num() == 0;
+
+	for (int32 i = 0; i < Components.Num(); ++i)
+	{
+		const UClass* actorClass = OwnerActors[i] ? OwnerActors[i]->GetClass() : nullptr;
+		const UClass* componentClass = Components[i] ? Components[i]->GetClass() : nullptr;
+		if (!bHasLastClass || actorClass != lastActorClass || componentClass != lastComponentClass)
+		{
+			lastClassResult = EvaluateClasses(actorClass, componentClass);
+			lastActorClass = actorClass;
+			lastComponentClass = componentClass;
+			bHasLastClass = true;
+		}
+
+		if (lastClassResult != ESelectionFilterResult::Undecided || bNoInstanceRules)
+		{
+			OutResults[i] = lastClassResult;
+			continue;
+		}
+
+		ESelectionFilterResult result = EvaluateTags(OwnerActors[i], Components[i]);
+		if (result == ESelectionFilterResult::Undecided)
+		{
+			for (const TPair<int32, FInstanceRule>& rule : InstanceRules)
+			{
+				result = rule.Value(OwnerActors[i], Components[i]);
+				if (result != ESelectionFilterResult::Undecided) break;
+			}
+		}
+		OutResults[i] = result;
+	}
+}
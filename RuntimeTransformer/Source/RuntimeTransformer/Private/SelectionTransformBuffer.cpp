@@ -0,0 +1,336 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "SelectionTransformBuffer.h"
+#include "Components/SceneComponent.h"
+#include "Async/ParallelFor.h"
+#include "SelectionVectorOps.h"
+
+namespace
+{
+	using RTTVectorOps::FScalarOps;
+	using RTTVectorOps::FVectorOps;
+
+	// The parts of the Delta Transform (and the Pivot) broadcast to the lane width of Ops
+	template<typename Ops>
+	struct TDeltaConstants
+	{
+		typedef typename Ops::Type T;
+
+		T Tx, Ty, Tz;				// Delta Location
+		T Px, Py, Pz;				// Pivot
+		T Qx, Qy, Qz, Qw;			// Delta Rotation
+		T M00, M01, M02;			// Delta Rotation as a 3x3 Matrix (to rotate offsets around the pivot)
+		T M10, M11, M12;
+		T M20, M21, M22;
+		T Sx, Sy, Sz;				// Delta Scale
+		T Two;
+
+		TDeltaConstants(const FTransform& Delta, const FVector& Pivot)
+		{
+			const FVector l = Delta.GetLocation();
+			const FQuat q = Delta.GetRotation();
+			const FVector s = Delta.GetScale3D();
+
+			Tx = Ops::Splat(l.X); Ty = Ops::Splat(l.Y); Tz = Ops::Splat(l.Z);
+			Px = Ops::Splat(Pivot.X); Py = Ops::Splat(Pivot.Y); Pz = Ops::Splat(Pivot.Z);
+			Qx = Ops::Splat(q.X); Qy = Ops::Splat(q.Y); Qz = Ops::Splat(q.Z); Qw = Ops::Splat(q.W);
+			Sx = Ops::Splat(s.X); Sy = Ops::Splat(s.Y); Sz = Ops::Splat(s.Z);
+			Two = Ops::Splat(2.0);
+
+			M00 = Ops::Splat(1.0 - 2.0 * (q.Y * q.Y + q.Z * q.Z));
+			M01 = Ops::Splat(2.0 * (q.X * q.Y - q.W * q.Z));
+			M02 = Ops::Splat(2.0 * (q.X * q.Z + q.W * q.Y));
+			M10 = Ops::Splat(2.0 * (q.X * q.Y + q.W * q.Z));
+			M11 = Ops::Splat(1.0 - 2.0 * (q.X * q.X + q.Z * q.Z));
+			M12 = Ops::Splat(2.0 * (q.Y * q.Z - q.W * q.X));
+			M20 = Ops::Splat(2.0 * (q.X * q.Z - q.W * q.Y));
+			M21 = Ops::Splat(2.0 * (q.Y * q.Z + q.W * q.X));
+			M22 = Ops::Splat(1.0 - 2.0 * (q.X * q.X + q.Y * q.Y));
+		}
+	};
+
+	// Applies the Delta to Ops::Width Components starting at Index
+	template<typename Ops, bool bTranslate, bool bRotate, bool bScale, bool bRotateOnLocalAxis>
+	FORCEINLINE void ApplyDeltaLanes(FSelectionTransformBuffer& Buffer, int32 Index, const TDeltaConstants<Ops>& C)
+	{
+		typedef typename Ops::Type T;
+
+		if (bRotate || bScale)
+		{
+			const T rx = Ops::Load(&Buffer.RotationX[Index]);
+			const T ry = Ops::Load(&Buffer.RotationY[Index]);
+			const T rz = Ops::Load(&Buffer.RotationZ[Index]);
+			const T rw = Ops::Load(&Buffer.RotationW[Index]);
+
+			if (bScale)
+			{
+				//Delta Scale is unrotated by the (old) Component Rotation since World Scale is not supported
+				// v' = v - 2w(r x v) + 2(r x (r x v))
+				const T cx = Ops::Sub(Ops::Mul(ry, C.Sz), Ops::Mul(rz, C.Sy));
+				const T cy = Ops::Sub(Ops::Mul(rz, C.Sx), Ops::Mul(rx, C.Sz));
+				const T cz = Ops::Sub(Ops::Mul(rx, C.Sy), Ops::Mul(ry, C.Sx));
+
+				const T ex = Ops::Sub(Ops::Mul(ry, cz), Ops::Mul(rz, cy));
+				const T ey = Ops::Sub(Ops::Mul(rz, cx), Ops::Mul(rx, cz));
+				const T ez = Ops::Sub(Ops::Mul(rx, cy), Ops::Mul(ry, cx));
+
+				const T sx = Ops::Load(&Buffer.ScaleX[Index]);
+				const T sy = Ops::Load(&Buffer.ScaleY[Index]);
+				const T sz = Ops::Load(&Buffer.ScaleZ[Index]);
+
+				Ops::Store(Ops::Add(sx, Ops::MulAdd(C.Two, Ops::Sub(ex, Ops::Mul(rw, cx)), C.Sx)), &Buffer.ScaleX[Index]);
+				Ops::Store(Ops::Add(sy, Ops::MulAdd(C.Two, Ops::Sub(ey, Ops::Mul(rw, cy)), C.Sy)), &Buffer.ScaleY[Index]);
+				Ops::Store(Ops::Add(sz, Ops::MulAdd(C.Two, Ops::Sub(ez, Ops::Mul(rw, cz)), C.Sz)), &Buffer.ScaleZ[Index]);
+			}
+
+			if (bRotate)
+			{
+				//Delta Rotation * Component Rotation
+				const T nw = Ops::Sub(Ops::Mul(C.Qw, rw), Ops::MulAdd(C.Qx, rx, Ops::MulAdd(C.Qy, ry, Ops::Mul(C.Qz, rz))));
+				const T nx = Ops::Sub(Ops::MulAdd(C.Qw, rx, Ops::MulAdd(C.Qx, rw, Ops::Mul(C.Qy, rz))), Ops::Mul(C.Qz, ry));
+				const T ny = Ops::Add(Ops::Sub(Ops::Mul(C.Qw, ry), Ops::Mul(C.Qx, rz)), Ops::MulAdd(C.Qy, rw, Ops::Mul(C.Qz, rx)));
+				const T nz = Ops::Add(Ops::Sub(Ops::MulAdd(C.Qw, rz, Ops::Mul(C.Qx, ry)), Ops::Mul(C.Qy, rx)), Ops::Mul(C.Qz, rw));
+
+				Ops::Store(nx, &Buffer.RotationX[Index]);
+				Ops::Store(ny, &Buffer.RotationY[Index]);
+				Ops::Store(nz, &Buffer.RotationZ[Index]);
+				Ops::Store(nw, &Buffer.RotationW[Index]);
+			}
+		}
+
+		const bool bRotateLocation = bRotate && !bRotateOnLocalAxis;
+		if (bRotateLocation || bTranslate)
+		{
+			T lx = Ops::Load(&Buffer.LocationX[Index]);
+			T ly = Ops::Load(&Buffer.LocationY[Index]);
+			T lz = Ops::Load(&Buffer.LocationZ[Index]);
+
+			if (bRotateLocation)
+			{
+				//rotate the offset from the Gizmo (Pivot) to the Component
+				const T ox = Ops::Sub(lx, C.Px);
+				const T oy = Ops::Sub(ly, C.Py);
+				const T oz = Ops::Sub(lz, C.Pz);
+
+				lx = Ops::MulAdd(C.M00, ox, Ops::MulAdd(C.M01, oy, Ops::MulAdd(C.M02, oz, C.Px)));
+				ly = Ops::MulAdd(C.M10, ox, Ops::MulAdd(C.M11, oy, Ops::MulAdd(C.M12, oz, C.Py)));
+				lz = Ops::MulAdd(C.M20, ox, Ops::MulAdd(C.M21, oy, Ops::MulAdd(C.M22, oz, C.Pz)));
+			}
+
+			if (bTranslate)
+			{
+				lx = Ops::Add(lx, C.Tx);
+				ly = Ops::Add(ly, C.Ty);
+				lz = Ops::Add(lz, C.Tz);
+			}
+
+			Ops::Store(lx, &Buffer.LocationX[Index]);
+			Ops::Store(ly, &Buffer.LocationY[Index]);
+			Ops::Store(lz, &Buffer.LocationZ[Index]);
+		}
+	}
+
+	// Applies the Delta to the Components in [Start, End)
+	template<bool bTranslate, bool bRotate, bool bScale, bool bRotateOnLocalAxis>
+	void ApplyDeltaKernel(FSelectionTransformBuffer& Buffer, const FTransform& Delta, const FVector& Pivot, int32 Start, int32 End)
+	{
+		const int32 VectorizedEnd = End - ((End - Start) % FVectorOps::Width);
+
+		const TDeltaConstants<FVectorOps> VectorConstants(Delta, Pivot);
+		for (int32 i = Start; i < VectorizedEnd; i += FVectorOps::Width)
+			ApplyDeltaLanes<FVectorOps, bTranslate, bRotate, bScale, bRotateOnLocalAxis>(Buffer, i, VectorConstants);
+
+		const TDeltaConstants<FScalarOps> ScalarConstants(Delta, Pivot);
+		for (int32 i = VectorizedEnd; i < End; ++i)
+			ApplyDeltaLanes<FScalarOps, bTranslate, bRotate, bScale, bRotateOnLocalAxis>(Buffer, i, ScalarConstants);
+	}
+
+	typedef void (*FApplyDeltaKernel)(FSelectionTransformBuffer&, const FTransform&, const FVector&, int32, int32);
+
+	// Components per ParallelFor task. Multiple of the vector width so only the last task has a scalar tail
+	const int32 ParallelBatchSize = 1024;
+
+	// Indexed by (Translate | Rotate << 1 | Scale << 2 | RotateOnLocalAxis << 3)
+#define RTT_DELTA_KERNEL(Index) &ApplyDeltaKernel<!!((Index) & 1), !!((Index) & 2), !!((Index) & 4), !!((Index) & 8)>
+	const FApplyDeltaKernel ApplyDeltaKernels[16] =
+	{
+		RTT_DELTA_KERNEL(0),	RTT_DELTA_KERNEL(1),	RTT_DELTA_KERNEL(2),	RTT_DELTA_KERNEL(3),
+		RTT_DELTA_KERNEL(4),	RTT_DELTA_KERNEL(5),	RTT_DELTA_KERNEL(6),	RTT_DELTA_KERNEL(7),
+		RTT_DELTA_KERNEL(8),	RTT_DELTA_KERNEL(9),	RTT_DELTA_KERNEL(10),	RTT_DELTA_KERNEL(11),
+		RTT_DELTA_KERNEL(12),	RTT_DELTA_KERNEL(13),	RTT_DELTA_KERNEL(14),	RTT_DELTA_KERNEL(15),
+	};
+#undef RTT_DELTA_KERNEL
+}
+
+void FSelectionTransformBuffer::Reserve(int32 Number)
+{
+	Components.Reserve(Number);
+	ComponentHandles.Reserve(Number);
+	LocationX.Reserve(Number); LocationY.Reserve(Number); LocationZ.Reserve(Number);
+	RotationX.Reserve(Number); RotationY.Reserve(Number); RotationZ.Reserve(Number); RotationW.Reserve(Number);
+	ScaleX.Reserve(Number); ScaleY.Reserve(Number); ScaleZ.Reserve(Number);
+}
+
+void FSelectionTransformBuffer::Reset()
+{
+	Components.Reset();
+	ComponentHandles.Reset();
+	LocationX.Reset(); LocationY.Reset(); LocationZ.Reset();
+	RotationX.Reset(); RotationY.Reset(); RotationZ.Reset(); RotationW.Reset();
+	ScaleX.Reset(); ScaleY.Reset(); ScaleZ.Reset();
+	AttachGroups.Reset();
+	WorldSpaceIndices.Reset();
+}
+
+void FSelectionTransformBuffer::BuildAttachGroups()
+{
+	AttachGroups.Reset();
+	WorldSpaceIndices.Reset();
+
+	TMap<TPair<USceneComponent*, FName>, int32> groupIndices;
+	for (int32 i = 0; i < Components.Num(); ++i)
+	{
+		USceneComponent* component = Components[i];
+		if (!component) continue;
+
+		if (component->IsUsingAbsoluteLocation() || component->IsUsingAbsoluteRotation() || component->IsUsingAbsoluteScale())
+		{
+			WorldSpaceIndices.Add(i);
+			continue;
+		}
+
+		const TPair<USceneComponent*, FName> key(component->GetAttachParent(), component->GetAttachSocketName());
+		int32* groupIndex = groupIndices.Find(key);
+		if (!groupIndex)
+		{
+			groupIndex = &groupIndices.Add(key, AttachGroups.Num());
+			AttachGroups.Add(FSelectionAttachGroup{ key.Key, key.Key, key.Value, {} });
+		}
+		AttachGroups[*groupIndex].Indices.Add(i);
+	}
+}
+
+FSelectionAttachSpace::FSelectionAttachSpace(const FSelectionAttachGroup& Group)
+	: bParentInvalid(Group.Parent && !IsValid(Group.Parent))
+	, bMirrored(false)
+	, InverseRotation(FQuat::Identity)
+	, InverseScale(FVector::OneVector)
+	, ParentLocation(FVector::ZeroVector)
+{
+	if (bParentInvalid || !Group.Parent) return;
+
+	const FTransform parentToWorld = Group.Parent->GetSocketTransform(Group.SocketName);
+	const FVector parentScale = parentToWorld.GetScale3D();
+	bMirrored = parentScale.GetMin() <= 0.f;
+
+	InverseRotation = parentToWorld.GetRotation().Inverse();
+	InverseScale = FTransform::GetSafeScaleReciprocal(parentScale);
+	ParentLocation = parentToWorld.GetLocation();
+}
+
+FTransform FSelectionAttachSpace::GetRelativeTransform(const FTransform& WorldTransform) const
+{
+	return FTransform(InverseRotation * WorldTransform.GetRotation()
+		, InverseRotation.RotateVector(WorldTransform.GetLocation() - ParentLocation) * InverseScale
+		, WorldTransform.GetScale3D() * InverseScale);
+}
+
+int32 FSelectionTransformBuffer::Add(USceneComponent* Component, const FTransform& Transform)
+{
+	const FVector location = Transform.GetLocation();
+	const FQuat rotation = Transform.GetRotation();
+	const FVector scale = Transform.GetScale3D();
+
+	LocationX.Add(location.X); LocationY.Add(location.Y); LocationZ.Add(location.Z);
+	RotationX.Add(rotation.X); RotationY.Add(rotation.Y); RotationZ.Add(rotation.Z); RotationW.Add(rotation.W);
+	ScaleX.Add(scale.X); ScaleY.Add(scale.Y); ScaleZ.Add(scale.Z);
+	ComponentHandles.Add(Component);
+	return Components.Add(Component);
+}
+
+void FSelectionTransformBuffer::RemoveDestroyedComponents()
+{
+	for (int32 i = 0; i < Components.Num(); ++i)
+	{
+		if (Components[i] && !ComponentHandles[i].IsValid())
+			Components[i] = nullptr;
+	}
+
+	for (FSelectionAttachGroup& group : AttachGroups)
+	{
+		if (!group.Parent || group.ParentHandle.IsValid()) continue;
+
+		group.Parent = nullptr;
+		for (int32 i : group.Indices)
+			Components[i] = nullptr;
+	}
+}
+
+FTransform FSelectionTransformBuffer::GetTransform(int32 Index) const
+{
+	return FTransform(
+		FQuat(RotationX[Index], RotationY[Index], RotationZ[Index], RotationW[Index]),
+		FVector(LocationX[Index], LocationY[Index], LocationZ[Index]),
+		FVector(ScaleX[Index], ScaleY[Index], ScaleZ[Index]));
+}
+
+void FSelectionTransformBuffer::SetTransform(int32 Index, const FTransform& Transform)
+{
+	const FVector location = Transform.GetLocation();
+	const FQuat rotation = Transform.GetRotation();
+	const FVector scale = Transform.GetScale3D();
+
+	LocationX[Index] = location.X; LocationY[Index] = location.Y; LocationZ[Index] = location.Z;
+	RotationX[Index] = rotation.X; RotationY[Index] = rotation.Y; RotationZ[Index] = rotation.Z; RotationW[Index] = rotation.W;
+	ScaleX[Index] = scale.X; ScaleY[Index] = scale.Y; ScaleZ[Index] = scale.Z;
+}
+
+void FSelectionTransformBuffer::CopyTransformsFrom(const FSelectionTransformBuffer& Other)
+{
+	check(Other.Num() == Num());
+	const SIZE_T size = Num() * sizeof(double);
+	FMemory::Memcpy(LocationX.GetData(), Other.LocationX.GetData(), size);
+	FMemory::Memcpy(LocationY.GetData(), Other.LocationY.GetData(), size);
+	FMemory::Memcpy(LocationZ.GetData(), Other.LocationZ.GetData(), size);
+	FMemory::Memcpy(RotationX.GetData(), Other.RotationX.GetData(), size);
+	FMemory::Memcpy(RotationY.GetData(), Other.RotationY.GetData(), size);
+	FMemory::Memcpy(RotationZ.GetData(), Other.RotationZ.GetData(), size);
+	FMemory::Memcpy(RotationW.GetData(), Other.RotationW.GetData(), size);
+	FMemory::Memcpy(ScaleX.GetData(), Other.ScaleX.GetData(), size);
+	FMemory::Memcpy(ScaleY.GetData(), Other.ScaleY.GetData(), size);
+	FMemory::Memcpy(ScaleZ.GetData(), Other.ScaleZ.GetData(), size);
+}
+
+bool FSelectionTransformBuffer::IsIdentityDelta(const FTransform& DeltaTransform)
+{
+	return DeltaTransform.GetLocation().IsZero()
+		&& DeltaTransform.GetRotation().Equals(FQuat::Identity, 0.0)
+		&& DeltaTransform.GetScale3D().IsZero();
+}
+
+bool FSelectionTransformBuffer::ApplyDelta(const FTransform& DeltaTransform, const FVector& Pivot, bool bRotateOnLocalAxis, bool bParallel)
+{
+	const bool bTranslate = !DeltaTransform.GetLocation().IsZero();
+	const bool bRotate = !DeltaTransform.GetRotation().Equals(FQuat::Identity, 0.0);
+	const bool bScale = !DeltaTransform.GetScale3D().IsZero();
+
+	const int32 kernelIndex = (bTranslate ? 1 : 0) | (bRotate ? 2 : 0) | (bScale ? 4 : 0) | (bRotateOnLocalAxis ? 8 : 0);
+	if ((kernelIndex & 7) == 0) return false;
+
+	const FApplyDeltaKernel kernel = ApplyDeltaKernels[kernelIndex];
+	const int32 num = Num();
+	if (bParallel && num > ParallelBatchSize)
+	{
+		const int32 numBatches = FMath::DivideAndRoundUp(num, ParallelBatchSize);
+		ParallelFor(numBatches, [&](int32 Batch)
+		{
+			const int32 start = Batch * ParallelBatchSize;
+			kernel(*this, DeltaTransform, Pivot, start, FMath::Min(start + ParallelBatchSize, num));
+		});
+	}
+	else
+		kernel(*this, DeltaTransform, Pivot, 0, num);
+
+	return true;
+}
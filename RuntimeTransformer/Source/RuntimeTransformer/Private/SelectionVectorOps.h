@@ -0,0 +1,52 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Math on one (FScalarOps) or 4 (FVectorOps) doubles at once, so the Selection kernels can be written once
+ * and instantiated for the vector loop and for its scalar tail.
+ */
+namespace RTTVectorOps
+{
+	// Operations on a single Component (used for the tail that does not fill a vector register)
+	struct FScalarOps
+	{
+		typedef double Type;
+		typedef bool MaskType;
+		enum { Width = 1 };
+		static FORCEINLINE Type Load(const double* Ptr) { return *Ptr; }
+		static FORCEINLINE void Store(Type Value, double* Ptr) { *Ptr = Value; }
+		static FORCEINLINE Type Splat(double Value) { return Value; }
+		static FORCEINLINE Type Add(Type A, Type B) { return A + B; }
+		static FORCEINLINE Type Sub(Type A, Type B) { return A - B; }
+		static FORCEINLINE Type Mul(Type A, Type B) { return A * B; }
+		static FORCEINLINE Type Div(Type A, Type B) { return A / B; }
+		static FORCEINLINE Type MulAdd(Type A, Type B, Type C) { return A * B + C; }
+		static FORCEINLINE Type Min(Type A, Type B) { return FMath::Min(A, B); }
+		static FORCEINLINE Type Max(Type A, Type B) { return FMath::Max(A, B); }
+		static FORCEINLINE MaskType CompareGT(Type A, Type B) { return A > B; }
+		static FORCEINLINE Type Select(MaskType Mask, Type A, Type B) { return Mask ? A : B; }
+	};
+
+	// Operations on 4 Components at once
+	struct FVectorOps
+	{
+		typedef VectorRegister4Double Type;
+		typedef VectorRegister4Double MaskType;
+		enum { Width = 4 };
+		static FORCEINLINE Type Load(const double* Ptr) { return VectorLoad(Ptr); }
+		static FORCEINLINE void Store(const Type& Value, double* Ptr) { VectorStore(Value, Ptr); }
+		static FORCEINLINE Type Splat(double Value) { return MakeVectorRegisterDouble(Value, Value, Value, Value); }
+		static FORCEINLINE Type Add(const Type& A, const Type& B) { return VectorAdd(A, B); }
+		static FORCEINLINE Type Sub(const Type& A, const Type& B) { return VectorSubtract(A, B); }
+		static FORCEINLINE Type Mul(const Type& A, const Type& B) { return VectorMultiply(A, B); }
+		static FORCEINLINE Type Div(const Type& A, const Type& B) { return VectorDivide(A, B); }
+		static FORCEINLINE Type MulAdd(const Type& A, const Type& B, const Type& C) { return VectorMultiplyAdd(A, B, C); }
+		static FORCEINLINE Type Min(const Type& A, const Type& B) { return VectorMin(A, B); }
+		static FORCEINLINE Type Max(const Type& A, const Type& B) { return VectorMax(A, B); }
+		static FORCEINLINE MaskType CompareGT(const Type& A, const Type& B) { return VectorCompareGT(A, B); }
+		static FORCEINLINE Type Select(const MaskType& Mask, const Type& A, const Type& B) { return VectorSelect(Mask, A, B); }
+	};
+}
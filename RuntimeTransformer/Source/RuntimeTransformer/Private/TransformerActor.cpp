@@ -3,11 +3,18 @@
 
 #include "TransformerActor.h"
 #include "Components/PrimitiveComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "UObject/ConstructorHelpers.h"
+#include "UObject/UObjectGlobals.h"
 #include "Engine/World.h"
 #include "GameFramework/PlayerController.h"
 
 #include "Net/UnrealNetwork.h"
 #include "Kismet/GameplayStatics.h"
+#include "Async/ParallelFor.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
 
 /* Gizmos */
 #include "Gizmos/BaseGizmo.h"
@@ -18,6 +25,39 @@
 /* Interface */
 #include "FocusableObject.h"
 
+#include "GizmoPoolSubsystem.h"
+#include "MeshPickingSubsystem.h"
+#include "EngineUtils.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/GameViewportClient.h"
+#include "SceneView.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Optional.h"
+
+DECLARE_CYCLE_STAT(TEXT("Select Components"), STAT_RTT_SelectComponents, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Deselect Components"), STAT_RTT_DeselectComponents, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Apply Delta Transform"), STAT_RTT_ApplyDeltaTransform, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Commit Transforms"), STAT_RTT_CommitTransforms, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Trace"), STAT_RTT_Trace, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Spatial Index Update"), STAT_RTT_SpatialIndexUpdate, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Spatial Index Query"), STAT_RTT_SpatialIndexQuery, STATGROUP_RuntimeTransformer);
+DECLARE_CYCLE_STAT(TEXT("Screen Selection"), STAT_RTT_ScreenSelection, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Spatial Index Entries"), STAT_RTT_SpatialIndexEntries, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Selected Components"), STAT_RTT_NumSelected, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Lagging Components"), STAT_RTT_LaggingComponents, STATGROUP_RuntimeTransformer);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Max Staleness (frames)"), STAT_RTT_MaxStalenessFrames, STATGROUP_RuntimeTransformer);
+
+static TAutoConsoleVariable<float> CVarApplyBudgetMs(
+	TEXT("RuntimeTransformer.ApplyBudgetMs"),
+	0.f,
+	TEXT("Milliseconds per frame a Transformer can spend setting the new Transforms of its Selected Components while dragging.\n")
+	TEXT("The Components left are set round-robin in the next frames, and all of them when the drag ends.\n")
+	TEXT("0 (default) sets every Component every frame."),
+	ECVF_Default);
+
+//Entries committed between reads of the clock (and at least committed per frame, so the Selection always catches up)
+static constexpr int32 SlicedCommitGranularity = 64;
+
 // Sets default values
 ATransformerActor::ATransformerActor()
 {
@@ -31,6 +71,22 @@ ATransformerActor::ATransformerActor()
 	TranslationGizmoClass	= ATranslationGizmo::StaticClass();
 	RotationGizmoClass		= ARotationGizmo::StaticClass();
 	ScaleGizmoClass			= AScaleGizmo::StaticClass();
+	bPreloadGizmoClasses	= true;
+	bAnalyticGizmoPicking	= true;
+	bGizmoCollision			= true;
+	bTriangleAccuratePicking = false;
+
+	bMaintainSpatialIndex = false;
+	SpatialIndexMargin = 10.f;
+
+	SelectionValidationFrame = 0;
+	bKeepStreamedOutSelection = false;
+	bCallShouldSelectByDefault = true;
+	bShouldSelectInScript = true; //known at BeginPlay
+
+	AsyncTraceDelegate.BindUObject(this, &ATransformerActor::OnAsyncTraceDone);
+	bPendingAsyncTraceAppend = false;
+	SelectionRevision = 0;
 
 	ResetDeltaTransform(AccumulatedDeltaTransform);
 
@@ -38,10 +94,39 @@ ATransformerActor::ATransformerActor()
 	SetSpaceType(CurrentSpaceType);
 
 	bTransformUFocusableObjects = true;
+	bBatchFocusableNotifications = false;
 	bRotateOnLocalAxis = false;
 	bForceMobility = false;
+	bRestoreMobilityOnDeselect = false;
 	bToggleSelectedInMultiSelection = true;
 	bComponentBased = false;
+
+	bTransformBufferValid = false;
+	bTransformFromDragStart = true;
+	bDragStartValid = false;
+	bDragStartAligned = false;
+	ResetDeltaTransform(DragTotalDelta);
+	DragPivot = FVector::ZeroVector;
+	bDragRotateOnLocalAxis = false;
+	SlicedCommitCursor = 0;
+	NumLaggingTransforms = 0;
+	SlicedCommitFrame = 0;
+	ParallelApplyThreshold = 4096;
+	bBatchTransformCommit = true;
+	bDeferOverlapsDuringTransform = false;
+
+	bEventDrivenTick = true;
+	bViewDirty = true;
+
+	PreviewProxyThreshold = 0;
+	bPreviewCommitPending = false;
+	bPreviewRigid = true;
+	PreviewGizmoAnchorIndex = INDEX_NONE;
+	static ConstructorHelpers::FObjectFinder<UStaticMesh> PreviewProxyMeshFinder(TEXT("/Engine/BasicShapes/Cube.Cube"));
+	PreviewProxyMesh = PreviewProxyMeshFinder.Object;
+	SelectionTransactionDepth = 0;
+	bSelectionChangePending = false;
+	bBroadcastPerComponentSelectionChange = true;
 }
 
 UObject* ATransformerActor::GetUFocusable(USceneComponent* Component) const
@@ -61,33 +146,114 @@ UObject* ATransformerActor::GetUFocusable(USceneComponent* Component) const
 	return nullptr;
 }
 
-void ATransformerActor::SetTransform(USceneComponent* Component, const FTransform& Transform)
+FCachedFocusable ATransformerActor::ResolveFocusable(USceneComponent* Component) const
+{
+	FCachedFocusable focusable;
+	UObject* focusableObject = GetUFocusable(Component);
+	if (!focusableObject) return focusable;
+
+	focusable.Object = focusableObject;
+
+	//Cast only finds the Interface on Classes that implement it in C++. A Blueprint child can still override the Events
+	if (IFocusableObject* nativeInterface = Cast<IFocusableObject>(focusableObject))
+	{
+		const UClass* focusableClass = focusableObject->GetClass();
+		if (!focusableClass->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(IFocusableObject, OnNewTransformation)))
+			focusable.NativeInterface = nativeInterface;
+		if (!focusableClass->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(IFocusableObject, OnNewTransformations)))
+			focusable.NativeBatchInterface = nativeInterface;
+	}
+	return focusable;
+}
+
+void ATransformerActor::SetTransform(USceneComponent* Component, const FTransform& Transform, const FTransform* RelativeTransform
+	, const FCachedFocusable* Focusable)
 {
 	if (!Component) return;
-	if (UObject* focusableObject = GetUFocusable(Component))
+	if (Focusable)
 	{
-		IFocusableObject::Execute_OnNewTransformation(focusableObject, this, Component, Transform, bComponentBased);
-		if (bTransformUFocusableObjects)
-			Component->SetWorldTransform(Transform);
+		if (!bBatchFocusableNotifications)
+			NotifyFocusable(*Focusable, Component, Transform);
+		if (!bTransformUFocusableObjects)
+			return;
 	}
+
+	if (RelativeTransform)
+		Component->SetRelativeTransform(*RelativeTransform);
+	else
+		Component->SetWorldTransform(Transform);
+}
+
+void ATransformerActor::NotifyFocusable(const FCachedFocusable& Focusable, USceneComponent* Component, const FTransform& Transform)
+{
+	UObject* focusableObject = Focusable.Object.Get();
+	if (!focusableObject) return;
+
+	if (Focusable.NativeInterface)
+		Focusable.NativeInterface->OnNewTransformation_Implementation(this, Component, Transform, bComponentBased);
 	else
+		IFocusableObject::Execute_OnNewTransformation(focusableObject, this, Component, Transform, bComponentBased);
+}
+
+void ATransformerActor::NotifyFocusableBatches(const TArray<int32>* Indices)
+{
+	struct FFocusableBatch
+	{
+		const FCachedFocusable* Focusable;
+		TArray<USceneComponent*> Components;
+		TArray<FTransform> Transforms;
+	};
+
+	TArray<FFocusableBatch, TInlineAllocator<4>> batches;
+	TMap<UObject*, int32> batchIndices;
+	const int32 numEntries = Indices ? Indices->Num() : TransformBuffer.Num();
+	for (int32 entry = 0; entry < numEntries; ++entry)
+	{
+		const int32 i = Indices ? (*Indices)[entry] : entry;
+		const FCachedFocusable* focusable = GetTransformFocusable(i);
+		UObject* focusableObject = focusable ? focusable->Object.Get() : nullptr;
+		USceneComponent* sc = TransformBuffer.Components[i];
+		if (!focusableObject || !IsValid(sc)) continue;
+
+		int32& batchIndex = batchIndices.FindOrAdd(focusableObject, INDEX_NONE);
+		if (batchIndex == INDEX_NONE)
+		{
+			batchIndex = batches.AddDefaulted();
+			batches[batchIndex].Focusable = focusable;
+		}
+		batches[batchIndex].Components.Add(sc);
+		batches[batchIndex].Transforms.Add(TransformBuffer.GetTransform(i));
+	}
+
+	for (const FFocusableBatch& batch : batches)
 	{
-	    Component->SetWorldTransform(Transform);
+		if (batch.Focusable->NativeBatchInterface)
+			batch.Focusable->NativeBatchInterface->OnNewTransformations_Implementation(this, batch.Components, batch.Transforms, bComponentBased);
+		else
+			IFocusableObject::Execute_OnNewTransformations(batch.Focusable->Object.Get(), this, batch.Components, batch.Transforms, bComponentBased);
 	}
 }
 
 void ATransformerActor::Select(USceneComponent* Component, bool* bImplementsUFocusable)
 {
-	UObject* focusableObject = GetUFocusable(Component);
+	const FCachedFocusable focusable = ResolveFocusable(Component);
+	UObject* focusableObject = focusable.Object.Get();
 	if (focusableObject)
+	{
+		FocusableCache.Add(Component, focusable);
 		IFocusableObject::Execute_Focus(focusableObject, this, Component, bComponentBased);
+	}
 	if (bImplementsUFocusable)
 		*bImplementsUFocusable = !!focusableObject;
 }
 
 void ATransformerActor::Deselect(USceneComponent* Component, bool* bImplementsUFocusable)
 {
-	UObject* focusableObject = GetUFocusable(Component);
+	RestoreMobility(Component);
+	UnmovableReportedComponents.Remove(Component);
+
+	FCachedFocusable focusable;
+	UObject* focusableObject = FocusableCache.RemoveAndCopyValue(Component, focusable) ? focusable.Object.Get() : nullptr;
 	if (focusableObject)
 		IFocusableObject::Execute_Unfocus(focusableObject, this, Component, bComponentBased);
 	if (bImplementsUFocusable)
@@ -96,12 +262,39 @@ void ATransformerActor::Deselect(USceneComponent* Component, bool* bImplementsUF
 
 void ATransformerActor::FilterHits(TArray<FHitResult>& outHits)
 {
+	if (!bTriangleAccuratePicking) return;
+
+	UMeshPickingSubsystem* meshPicking = GetMeshPicking();
+	if (!meshPicking) return;
+
+	bool bRefined = false;
+	for (int32 i = outHits.Num() - 1; i >= 0; --i)
+	{
+		//Gizmos are picked by their Domain Components, not by their Triangles
+		if (Cast<ABaseGizmo>(outHits[i].GetActor())) continue;
+
+		switch (meshPicking->RefineHit(outHits[i]))
+		{
+		case EMeshPickResult::Miss:
+			outHits.RemoveAt(i, 1, EAllowShrinking::No);
+			break;
+		case EMeshPickResult::Hit:
+			bRefined = true;
+			break;
+		default:
+			break;
+		}
+	}
 
+	//a refined hit can be farther than the Collision hits after it
+	if (bRefined)
+		outHits.StableSort([](const FHitResult& A, const FHitResult& B) { return A.Distance < B.Distance; });
 }
 
 void ATransformerActor::SetSpaceType(ESpaceType Type)
 {
 	CurrentSpaceType = Type;
+	MarkViewDirty();
 	SetGizmo();
 }
 
@@ -118,6 +311,33 @@ void ATransformerActor::ClearDomain()
 	SetDomain(ETransformationDomain::TD_None);
 }
 
+void ATransformerActor::CancelTransform()
+{
+	if (CurrentDomain != ETransformationDomain::TD_None && bDragStartValid)
+	{
+		if (bTransformBufferValid && bDragStartAligned)
+		{
+			//the previewed / lagging Transforms are replaced by the start ones, so each Component is only set once
+			TransformBuffer.CopyTransformsFrom(DragStartBuffer);
+			if (bPreviewCommitPending)
+				EndTransformPreview();
+			else
+				CommitTransformBuffer();
+		}
+		else
+		{
+			//the TransformBuffer does not match the start one anymore, so it is committed first and then undone
+			InvalidateTransformBuffer();
+			for (int32 i = 0; i < DragStartBuffer.Num(); ++i)
+			{
+				USceneComponent* sc = DragStartBuffer.Components[i];
+				if (IsValid(sc)) SetTransform(sc, DragStartBuffer.GetTransform(i), nullptr, FocusableCache.Find(sc));
+			}
+		}
+	}
+	ClearDomain();
+}
+
 bool ATransformerActor::CalculateMouseWorldPosition(float TraceDistance, FVector& outStartPoint, FVector& outEndPoint)
 {
 	if (APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0)/*Cast< APlayerController>(Controller)*/)
@@ -138,13 +358,58 @@ UClass* ATransformerActor::GetGizmoClass(ETransformationType TransformationType)
 	//Assign correct Gizmo Class depending on given Transformation
 	switch (TransformationType)
 	{
-	case ETransformationType::TT_Translation:	return TranslationGizmoClass;
-	case ETransformationType::TT_Rotation:		return RotationGizmoClass;
-	case ETransformationType::TT_Scale:			return ScaleGizmoClass;
+	case ETransformationType::TT_Translation:	return TranslationGizmoClass.Get();
+	case ETransformationType::TT_Rotation:		return RotationGizmoClass.Get();
+	case ETransformationType::TT_Scale:			return ScaleGizmoClass.Get();
 	default:									return nullptr;
 	}
 }
 
+bool ATransformerActor::RequestGizmoClasses()
+{
+	//a finished handle means the load was already attempted (classes that failed to load stay null)
+	if (GizmoClassesHandle.IsValid())
+		return GizmoClassesHandle->HasLoadCompleted() || GizmoClassesHandle->WasCanceled();
+
+	TArray<FSoftObjectPath> pendingClasses;
+	for (const FSoftObjectPath& classPath : { TranslationGizmoClass.ToSoftObjectPath()
+		, RotationGizmoClass.ToSoftObjectPath(), ScaleGizmoClass.ToSoftObjectPath() })
+	{
+		if (!classPath.IsNull() && !classPath.ResolveObject())
+			pendingClasses.Add(classPath);
+	}
+
+	if (pendingClasses.Num() == 0)
+		return true;
+
+	GizmoClassesHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(pendingClasses
+		, FStreamableDelegate::CreateUObject(this, &ATransformerActor::OnGizmoClassesLoaded));
+
+	return false;
+}
+
+void ATransformerActor::OnGizmoClassesLoaded()
+{
+	if (!HasActorBegunPlay()) return;
+
+	PrewarmGizmoPool();
+
+	//the Selection happened while the Gizmo Classes were loading
+	if (SelectedComponents.Num() > 0 && !Gizmo.IsValid())
+		UpdateGizmoPlacement();
+}
+
+void ATransformerActor::PrewarmGizmoPool()
+{
+	//Spawn every Gizmo type up front so the first switch to it does not hitch. The Pool is shared by all Transformers in the World
+	if (UGizmoPoolSubsystem* gizmoPool = GetGizmoPool())
+	{
+		gizmoPool->Prewarm(TranslationGizmoClass.Get());
+		gizmoPool->Prewarm(RotationGizmoClass.Get());
+		gizmoPool->Prewarm(ScaleGizmoClass.Get());
+	}
+}
+
 void ATransformerActor::ResetDeltaTransform(FTransform& Transform)
 {
 	Transform = FTransform();
@@ -153,7 +418,22 @@ void ATransformerActor::ResetDeltaTransform(FTransform& Transform)
 
 void ATransformerActor::SetDomain(ETransformationDomain Domain)
 {
+	const bool bWasInProgress = CurrentDomain != ETransformationDomain::TD_None;
+	if (CurrentDomain != Domain)
+		++SelectionRevision;
 	CurrentDomain = Domain;
+	const bool bInProgress = CurrentDomain != ETransformationDomain::TD_None;
+	MarkViewDirty();
+
+	//the Transforms are gathered again at the start of the next Transform (this also commits any Transform Preview)
+	InvalidateTransformBuffer();
+	if (bWasInProgress != bInProgress)
+		bDragStartValid = false;
+
+	if (!bWasInProgress && bInProgress)
+		OnTransformBegin();
+	else if (bWasInProgress && !bInProgress)
+		OnTransformEnd();
 
 	if (Gizmo.IsValid())
 	{
@@ -209,6 +489,11 @@ bool ATransformerActor::TraceByObjectTypes(const FVector& StartLocation
 	, bool bAppendToList
 	, bool bTraceComplex)
 {
+	SCOPE_CYCLE_COUNTER(STAT_RTT_Trace);
+
+	if (PickGizmoDomain(StartLocation, EndLocation))
+		return true;
+
 	if (UWorld* world = GetWorld())
 	{
 		FCollisionObjectQueryParams CollisionObjectQueryParams;
@@ -239,6 +524,11 @@ bool ATransformerActor::TraceByChannel(const FVector& StartLocation
 	, bool bAppendToList
 	, bool bTraceComplex)
 {
+	SCOPE_CYCLE_COUNTER(STAT_RTT_Trace);
+
+	if (PickGizmoDomain(StartLocation, EndLocation))
+		return true;
+
 	if (UWorld* world = GetWorld())
 	{
 		FCollisionQueryParams CollisionQueryParams;
@@ -264,6 +554,11 @@ bool ATransformerActor::TraceByProfile(const FVector& StartLocation
 	, bool bAppendToList
 	, bool bTraceComplex)
 {
+	SCOPE_CYCLE_COUNTER(STAT_RTT_Trace);
+
+	if (PickGizmoDomain(StartLocation, EndLocation))
+		return true;
+
 	if (UWorld* world = GetWorld())
 	{
 		FCollisionQueryParams CollisionQueryParams;
@@ -281,180 +576,1284 @@ bool ATransformerActor::TraceByProfile(const FVector& StartLocation
 	return false;
 }
 
+FTransformerTraceQuery ATransformerActor::MakeTraceQueryByObjectTypes(const TArray<TEnumAsByte<ECollisionChannel>>& CollisionChannels
+	, const TArray<AActor*>& IgnoredActors, bool bTraceComplex)
+{
+	return FTransformerTraceQuery::ByObjectTypes(CollisionChannels, IgnoredActors, bTraceComplex);
+}
+
+FTransformerTraceQuery ATransformerActor::MakeTraceQueryByChannel(TEnumAsByte<ECollisionChannel> TraceChannel
+	, const TArray<AActor*>& IgnoredActors, bool bTraceComplex)
+{
+	return FTransformerTraceQuery::ByChannel(TraceChannel, IgnoredActors, bTraceComplex);
+}
+
+FTransformerTraceQuery ATransformerActor::MakeTraceQueryByProfile(FName ProfileName
+	, const TArray<AActor*>& IgnoredActors, bool bTraceComplex)
+{
+	return FTransformerTraceQuery::ByProfile(ProfileName, IgnoredActors, bTraceComplex);
+}
+
+bool ATransformerActor::TraceWithQuery(FTransformerTraceQuery& Query
+	, const FVector& StartLocation
+	, const FVector& EndLocation
+	, bool bAppendToList)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTT_Trace);
+
+	if (PickGizmoDomain(StartLocation, EndLocation))
+		return true;
+
+	//Our Gizmo was already picked analytically, so HandleTracedObjects only needs the first blocking hit
+	// (unless it can be discarded when refined to its Triangles)
+	const bool bSingleHit = Query.bSingleBlockingHit && bAnalyticGizmoPicking && !bTriangleAccuratePicking;
+	if (!Query.Trace(GetWorld(), StartLocation, EndLocation, bSingleHit)) return false;
+	FilterHits(Query.Hits);
+
+	//A Gizmo is never Selected (it can be ours with Collision, or another Transformer's), and neither is a filtered out hit.
+	//The Objects behind them need the full trace
+	if (bSingleHit && (Query.Hits.Num() == 0 || Cast<ABaseGizmo>(Query.Hits[0].GetActor())))
+	{
+		if (!Query.Trace(GetWorld(), StartLocation, EndLocation, false)) return false;
+		FilterHits(Query.Hits);
+	}
+	return HandleTracedObjects(Query.Hits, bAppendToList);
+}
+
+bool ATransformerActor::MouseTraceWithQuery(FTransformerTraceQuery& Query
+	, float TraceDistance
+	, bool bAppendToList)
+{
+	FVector start, end;
+	if (CalculateMouseWorldPosition(TraceDistance, start, end))
+		return TraceWithQuery(Query, start, end, bAppendToList);
+	return false;
+}
+
+bool ATransformerActor::AsyncTraceByObjectTypes(const FVector& StartLocation
+	, const FVector& EndLocation
+	, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels
+	, TArray<AActor*> IgnoredActors
+	, bool bAppendToList
+	, bool bTraceComplex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTT_Trace);
+
+	if (PickGizmoDomain(StartLocation, EndLocation))
+		return true;
+
+	if (UWorld* world = GetWorld())
+	{
+		FCollisionObjectQueryParams CollisionObjectQueryParams;
+		FCollisionQueryParams CollisionQueryParams;
+		CollisionQueryParams.bTraceComplex = bTraceComplex;
+
+		for (auto& cc : CollisionChannels)
+			CollisionObjectQueryParams.AddObjectTypesToQuery(cc);
+
+		CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+
+		return QueueAsyncTrace(world->AsyncLineTraceByObjectType(EAsyncTraceType::Multi, StartLocation, EndLocation
+			, CollisionObjectQueryParams, CollisionQueryParams, &AsyncTraceDelegate, SelectionRevision), bAppendToList);
+	}
+	return false;
+}
+
+bool ATransformerActor::AsyncTraceByChannel(const FVector& StartLocation
+	, const FVector& EndLocation
+	, TEnumAsByte<ECollisionChannel> TraceChannel
+	, TArray<AActor*> IgnoredActors
+	, bool bAppendToList
+	, bool bTraceComplex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTT_Trace);
+
+	if (PickGizmoDomain(StartLocation, EndLocation))
+		return true;
+
+	if (UWorld* world = GetWorld())
+	{
+		FCollisionQueryParams CollisionQueryParams;
+		CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+		CollisionQueryParams.bTraceComplex = bTraceComplex;
+
+		return QueueAsyncTrace(world->AsyncLineTraceByChannel(EAsyncTraceType::Multi, StartLocation, EndLocation
+			, TraceChannel, CollisionQueryParams, FCollisionResponseParams::DefaultResponseParam, &AsyncTraceDelegate, SelectionRevision), bAppendToList);
+	}
+	return false;
+}
+
+bool ATransformerActor::AsyncTraceByProfile(const FVector& StartLocation
+	, const FVector& EndLocation
+	, const FName& ProfileName
+	, TArray<AActor*> IgnoredActors
+	, bool bAppendToList
+	, bool bTraceComplex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTT_Trace);
+
+	if (PickGizmoDomain(StartLocation, EndLocation))
+		return true;
+
+	if (UWorld* world = GetWorld())
+	{
+		FCollisionQueryParams CollisionQueryParams;
+		CollisionQueryParams.AddIgnoredActors(IgnoredActors);
+		CollisionQueryParams.bTraceComplex = bTraceComplex;
+
+		return QueueAsyncTrace(world->AsyncLineTraceByProfile(EAsyncTraceType::Multi, StartLocation, EndLocation
+			, ProfileName, CollisionQueryParams, &AsyncTraceDelegate, SelectionRevision), bAppendToList);
+	}
+	return false;
+}
+
+bool ATransformerActor::QueueAsyncTrace(const FTraceHandle& TraceHandle, bool bAppendToList)
+{
+	if (!TraceHandle.IsValid()) return false;
+
+	//the Selection Revision is carried by the Trace itself so that its result can be checked against the current one
+	PendingAsyncTrace = TraceHandle;
+	bPendingAsyncTraceAppend = bAppendToList;
+	return true;
+}
+
+void ATransformerActor::OnAsyncTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	//a newer Async Trace was requested
+	if (TraceHandle != PendingAsyncTrace) return;
+	PendingAsyncTrace = FTraceHandle();
+
+	//the Selection (or Domain) changed after the Trace was requested
+	if (TraceDatum.UserData != SelectionRevision) return;
+
+	bool bTracedSuccessfully = false;
+	if (TraceDatum.OutHits.Num() > 0)
+	{
+		FilterHits(TraceDatum.OutHits);
+		bTracedSuccessfully = HandleTracedObjects(TraceDatum.OutHits, bPendingAsyncTraceAppend);
+	}
+	OnAsyncTraceCompleted.Broadcast(bTracedSuccessfully);
+}
+
 void ATransformerActor::Tick(float DeltaSeconds)
 {
 	Super::Tick(DeltaSeconds);
+
+	//the Selection is only checked once per frame, instead of on every access
+	PruneInvalidSelection();
 	if (!Gizmo.IsValid()) return;
 
-	if (APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0) /*Cast< APlayerController>(Controller)*/)
+	//Only consider Local View
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0) /*Cast< APlayerController>(Controller)*/;
+	APlayerCameraManager* CameraManager = PlayerController ? PlayerController->PlayerCameraManager : nullptr;
+
+	FTransformerViewSnapshot view;
+	if (CameraManager)
 	{
-		FVector worldLocation, worldDirection;
-		if (PlayerController->IsLocalController() && PlayerController->PlayerCameraManager)
-		{
-			if (PlayerController->DeprojectMousePositionToWorld(worldLocation, worldDirection))
-			{
-				UpdateTransform(PlayerController->PlayerCameraManager->GetActorForwardVector(), worldLocation, worldDirection);
-			}
-		}
+		view.CameraLocation = CameraManager->GetCameraLocation();
+		view.CameraForward = CameraManager->GetActorForwardVector();
+		view.FieldOfView = CameraManager->GetFOVAngle();
+		view.bHasMouseRay = PlayerController->IsLocalController()
+			&& PlayerController->DeprojectMousePositionToWorld(view.RayOrigin, view.RayDirection);
 	}
+	if (USceneComponent* gizmoParent = Gizmo->GetRootComponent()->GetAttachParent())
+		view.GizmoParentTransform = gizmoParent->GetComponentTransform();
 
-	//Only consider Local View
-	if (APlayerController* LocalPlayerController = UGameplayStatics::GetPlayerController(this, 0))
+	//In Event Driven mode, the work below only happens when something it depends on has changed
+	const bool bForceUpdate = !bEventDrivenTick || bViewDirty;
+
+	if (view.bHasMouseRay && CurrentDomain != ETransformationDomain::TD_None
+		&& (bForceUpdate || !view.HasSameRay(LastView)))
 	{
-		if (LocalPlayerController->PlayerCameraManager)
-		{
-			Gizmo->ScaleGizmoScene(LocalPlayerController->PlayerCameraManager->GetCameraLocation()
-				, LocalPlayerController->PlayerCameraManager->GetActorForwardVector()
-				, LocalPlayerController->PlayerCameraManager->GetFOVAngle());
-		}
+		UpdateTransform(view.CameraForward, view.RayOrigin, view.RayDirection);
+		view.GizmoParentTransform = Gizmo->GetRootComponent()->GetAttachParent()
+			? Gizmo->GetRootComponent()->GetAttachParent()->GetComponentTransform() : FTransform::Identity;
 	}
 
-	Gizmo->UpdateGizmoSpace(CurrentSpaceType); //ToDo: change when this is called to improve performance when a gizmo is there without doing anything
+	//the Components left behind by the Apply Budget keep catching up while the mouse rests
+	if (NumLaggingTransforms > 0 && SlicedCommitFrame != GFrameCounter)
+		CommitTransformBufferSliced();
+
+	//while Previewing, the Gizmo is placed by UpdateTransformPreview since the Component it is attached to is not moving
+	if (!bPreviewCommitPending && (bForceUpdate || !view.GizmoParentTransform.Equals(LastView.GizmoParentTransform)))
+		Gizmo->UpdateGizmoSpace(CurrentSpaceType);
+
+	view.GizmoTransform = Gizmo->GetActorTransform();
+	if (CameraManager && (bForceUpdate || !view.HasSameCamera(LastView) || !view.GizmoTransform.Equals(LastView.GizmoTransform)))
+		Gizmo->ScaleGizmoScene(view.CameraLocation, view.CameraForward, view.FieldOfView);
+
+	LastView = view;
+	bViewDirty = false;
+}
+
+void ATransformerActor::MarkViewDirty()
+{
+	bViewDirty = true;
+}
+
+void ATransformerActor::RefreshTickState()
+{
+	//Only stop Ticking if nothing else (e.g. a Blueprint Tick) relies on it
+	if (bEventDrivenTick && !GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(ATransformerActor, ReceiveTick)))
+		SetActorTickEnabled(Gizmo.IsValid());
+	else
+		SetActorTickEnabled(true);
 }
 
 void ATransformerActor::BeginPlay()
 {
     Super::BeginPlay();
+    RefreshTickState();
+
+    //the Selection Filter is set up before the Spatial Index is built with it
+    SelectionFilter.SetRules(SelectionFilterRules);
+    bShouldSelectInScript = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(ATransformerActor, ShouldSelect));
 
-    for (auto it = GizmoActorPool.CreateIterator(); it; ++it)
+    //Gizmo Classes are soft references, so that an idle Transformer does not load the Gizmo assets with the map
+    if (bPreloadGizmoClasses && RequestGizmoClasses())
+        PrewarmGizmoPool();
+
+    if (bMaintainSpatialIndex)
     {
-        if (it->IsValid())
+        if (UWorld* world = GetWorld())
         {
-            (*it)->Destroy();
-            it.RemoveCurrentSwap();
+            ActorSpawnedHandle = world->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &ATransformerActor::AddActorToSpatialIndex));
+            ActorDestroyedHandle = world->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &ATransformerActor::RemoveActorFromSpatialIndex));
         }
+        RebuildSpatialIndex();
     }
 
-    TArray TransformationTypes = {
-        ETransformationType::TT_Translation,
-        ETransformationType::TT_Rotation,
-        ETransformationType::TT_Scale
-    };
-
-    GizmoActorPool.SetNum(TransformationTypes.Num());
-    int i = 0;
-    for (ETransformationType& tt : TransformationTypes)
+    if (bKeepStreamedOutSelection)
     {
-        ABaseGizmo* gizmo = CreateGizmo(tt);
-        gizmo->SetActorHiddenInGame(true);
-        gizmo->SetActorEnableCollision(false);
-        gizmo->SetActorTickEnabled(false);
-        ensureMsgf(gizmo, TEXT("Gizmo of type %s could not be created!"), *StaticEnum<ETransformationType>()->GetNameStringByValue(static_cast<int64>(tt)));
-        if (gizmo)
-        {
-            GizmoActorPool[i] = (gizmo);
-        }
-        ++i;
-        return;
+        LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &ATransformerActor::OnLevelRemovedFromWorld);
+        LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &ATransformerActor::OnLevelAddedToWorld);
     }
+
+    PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &ATransformerActor::OnPostGarbageCollect);
 }
 
 void ATransformerActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+    //give the Gizmo back to the Pool so other Transformers can use it
+    ResetGizmo();
+
+    if (GizmoClassesHandle.IsValid() && GizmoClassesHandle->IsLoadingInProgress())
+        GizmoClassesHandle->CancelHandle();
+
+    if (UWorld* world = GetWorld())
+    {
+        world->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+        world->RemoveOnActorDestroyedHandler(ActorDestroyedHandle);
+    }
+
+    FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+    FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+    FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
     Super::EndPlay(EndPlayReason);
-    for (TWeakObjectPtr gizmo : GizmoActorPool)
+}
+
+#if WITH_EDITOR
+void ATransformerActor::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    FName PropertyName = PropertyChangedEvent.GetPropertyName();
+    FString PropertyNameString = PropertyName.ToString();
+    if (PropertyName != GET_MEMBER_NAME_CHECKED(ATransformerActor, Gizmo) && PropertyNameString.StartsWith(TEXT("Current"), ESearchCase::IgnoreCase))
     {
-        if (gizmo.IsValid())
-        {
-            gizmo->Destroy();
-        }
+        UpdateGizmoPlacement();
     }
 }
+#endif
+
+FTransform ATransformerActor::UpdateTransform(const FVector& LookingVector
+                                             , const FVector& RayOrigin
+                                             , const FVector& RayDirection)
+{
+	FTransform deltaTransform;
+	deltaTransform.SetScale3D(FVector::ZeroVector);
+
+	if (!Gizmo.IsValid() || CurrentDomain == ETransformationDomain::TD_None)
+		return deltaTransform;
+
+	FVector rayEnd = RayOrigin + 1'000'000'00 * RayDirection;
+
+	FTransform calcDeltaTransform = Gizmo->GetDeltaTransform(LookingVector, RayOrigin, rayEnd, CurrentDomain);
+
+	//The delta transform we are actually going to apply (same if there is no Snapping taking place)
+	deltaTransform = calcDeltaTransform;
+
+	/* SNAPPING LOGIC */
+	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
+	float* snappingValue = SnappingValues.Find(CurrentTransformation);
+
+	if (snappingEnabled && *snappingEnabled && snappingValue)
+			deltaTransform = Gizmo->GetSnappedTransform(AccumulatedDeltaTransform
+				, calcDeltaTransform, CurrentDomain, *snappingValue);
+				//GetSnapped Transform Modifies Accumulated Delta Transform by how much Snapping Occurred
+
+	ApplyDeltaTransform(deltaTransform);
+	return deltaTransform;
+}
+
+void ATransformerActor::ApplyDeltaTransform(const FTransform& DeltaTransform)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTT_ApplyDeltaTransform);
+
+	//a destroyed Selected Component invalidates the Transform Buffer
+	PruneInvalidSelection();
+	const bool bGathered = !bTransformBufferValid;
+	if (bGathered)
+		GatherSelectedTransforms();
+
+	ABaseGizmo* gizmo = Gizmo.Get();
+	const FVector gizmoLocation = gizmo ? gizmo->GetActorLocation() : FVector::ZeroVector;
+
+	const bool bFromDragStart = bTransformFromDragStart && bDragStartAligned
+		&& CurrentDomain != ETransformationDomain::TD_None && AccumulateDragDelta(DeltaTransform, gizmoLocation);
+
+	if (!bGathered && !bFromDragStart && !bPreviewCommitPending)
+	{
+		//these are not moved by us, so their Transform could have changed since last frame
+		// (from the drag start, they are given the Transform they would have if we moved them instead)
+		for (int32 i : UnappliedTransformIndices)
+			if (IsValid(TransformBuffer.Components[i]))
+				TransformBuffer.SetTransform(i, TransformBuffer.Components[i]->GetComponentTransform());
+	}
+
+	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
+	float* snappingValue = SnappingValues.Find(CurrentTransformation);
+	const bool bSnapPerComponent = snappingEnabled && *snappingEnabled && snappingValue && gizmo;
+
+	//New Transforms are computed in parallel for large selections, but always committed here (Game Thread)
+	const int32 numTransforms = TransformBuffer.Num();
+	const bool bParallel = ParallelApplyThreshold > 0 && numTransforms >= ParallelApplyThreshold;
+
+	//Per Component Snapping needs the Transforms before the Delta was applied (the drag start ones if bFromDragStart)
+	TArray<FTransform> oldTransforms;
+	if (bSnapPerComponent && !bFromDragStart)
+	{
+		oldTransforms.SetNumUninitialized(numTransforms);
+		ParallelFor(numTransforms, [&](int32 i)
+		{
+			oldTransforms[i] = TransformBuffer.GetTransform(i);
+		}, !bParallel);
+	}
+
+	const bool bPreview = CurrentDomain != ETransformationDomain::TD_None
+		&& PreviewProxyThreshold > 0 && numTransforms >= PreviewProxyThreshold;
+	if (bPreview && !bPreviewCommitPending)
+		BeginTransformPreview();
+
+	bool bApplied;
+	if (bFromDragStart)
+	{
+		//every frame starts over from the drag start, so the result does not depend on how the drag was split in frames
+		bApplied = !FSelectionTransformBuffer::IsIdentityDelta(DeltaTransform);
+		if (bApplied)
+		{
+			TransformBuffer.CopyTransformsFrom(DragStartBuffer);
+			TransformBuffer.ApplyDelta(DragTotalDelta, DragPivot, bDragRotateOnLocalAxis, bParallel);
+		}
+	}
+	else
+		bApplied = TransformBuffer.ApplyDelta(DeltaTransform, gizmoLocation, bRotateOnLocalAxis, bParallel);
+
+	if (bApplied)
+	{
+		/* SNAPPING LOGIC PER COMPONENT */
+		if (bSnapPerComponent)
+		{
+			const float snapping = *snappingValue;
+			const ETransformationDomain domain = CurrentDomain;
+			//GetSnappedTransformPerComponent only does math on the given transforms, so it is safe off the Game Thread
+			ParallelFor(numTransforms, [&](int32 i)
+			{
+				TransformBuffer.SetTransform(i, gizmo->GetSnappedTransformPerComponent(
+					bFromDragStart ? DragStartBuffer.GetTransform(i) : oldTransforms[i]
+					, TransformBuffer.GetTransform(i), domain, snapping));
+			}, !bParallel);
+		}
+
+		if (bPreviewCommitPending)
+			UpdateTransformPreview(DeltaTransform, gizmoLocation);
+		else if (CurrentDomain != ETransformationDomain::TD_None && CVarApplyBudgetMs.GetValueOnGameThread() > 0.f)
+		{
+			MarkTransformBufferStale();
+			CommitTransformBufferSliced();
+		}
+		else
+			CommitTransformBuffer();
+	}
+
+	//Outside of a Transform (e.g. called directly) the Components might be moved by something else before the next call
+	if (CurrentDomain == ETransformationDomain::TD_None)
+		InvalidateTransformBuffer();
+}
+
+void ATransformerActor::CommitTransformBuffer()
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTT_CommitTransforms);
+	const int32 numTransforms = TransformBuffer.Num();
+
+	//Defer the Child Transform & Overlap updates of every Component until all of them have been moved,
+	// so that each Component propagates its move only once even if its parents/children are also being moved.
+	//Reserved up front: the Components point to their scopes, so these must never be relocated.
+	TArray<FScopedMovementUpdate> movementScopes;
+	if (bBatchTransformCommit)
+	{
+		movementScopes.Reserve(numTransforms);
+		for (int32 i = 0; i < numTransforms; ++i)
+		{
+			USceneComponent* sc = TransformBuffer.Components[i];
+			if (IsValid(sc))
+				movementScopes.Emplace(sc, EScopedUpdate::DeferredUpdates);
+		}
+	}
+
+	//Components sharing an Attach Parent get their Relative Transform from the same Parent (inverse) Transform,
+	// instead of each of them getting the Parent Socket Transform and inverting it in SetWorldTransform
+	for (const FSelectionAttachGroup& group : TransformBuffer.AttachGroups)
+	{
+		const FSelectionAttachSpace space(group);
+		if (space.bParentInvalid) continue;
+
+		for (int32 i : group.Indices)
+			CommitTransformEntry(i, &space);
+	}
+
+	//Components using Absolute Location/Rotation/Scale
+	for (int32 i : TransformBuffer.WorldSpaceIndices)
+		CommitTransformEntry(i, nullptr);
+
+	//close the scopes in reverse order (this is where the deferred updates run).
+	//Destroyed in place: they can't be copied or moved out, since the Components point to them
+	for (int32 i = movementScopes.Num() - 1; i >= 0; --i)
+		movementScopes.RemoveAt(i, 1, EAllowShrinking::No);
+
+	if (bBatchFocusableNotifications)
+		NotifyFocusableBatches();
+
+	//the Bounds are read when the Spatial Index is next queried, so a drag does not update it every frame
+	if (bMaintainSpatialIndex)
+	{
+		for (USceneComponent* sc : TransformBuffer.Components)
+			SpatialIndexDirtyComponents.Add(sc);
+	}
+
+	//every Component is up to date, including the ones a Time Sliced commit had left behind
+	if (NumLaggingTransforms > 0)
+	{
+		FMemory::Memzero(TransformStaleSince.GetData(), TransformStaleSince.Num() * sizeof(uint64));
+		NumLaggingTransforms = 0;
+		UpdateLaggingStats();
+	}
+}
+
+void ATransformerActor::CommitTransformEntry(int32 Index, const FSelectionAttachSpace* Space)
+{
+	USceneComponent* sc = TransformBuffer.Components[Index];
+	if (!IsValid(sc)) return;
+
+	const FTransform worldTransform = TransformBuffer.GetTransform(Index);
+	if (Space && !Space->bMirrored)
+	{
+		const FTransform relativeTransform = Space->GetRelativeTransform(worldTransform);
+		SetTransform(sc, worldTransform, &relativeTransform, GetTransformFocusable(Index));
+	}
+	else
+		SetTransform(sc, worldTransform, nullptr, GetTransformFocusable(Index));
+}
+
+void ATransformerActor::MarkTransformBufferStale()
+{
+	const int32 numTransforms = TransformBuffer.Num();
+	if (TransformStaleSince.Num() != numTransforms)
+		TransformStaleSince.SetNumZeroed(numTransforms);
+
+	//entries that are already lagging keep the frame they started lagging at
+	const uint64 frame = GFrameCounter + 1;
+	for (uint64& staleSince : TransformStaleSince)
+	{
+		if (staleSince == 0)
+		{
+			staleSince = frame;
+			++NumLaggingTransforms;
+		}
+	}
+}
+
+void ATransformerActor::CommitTransformBufferSliced()
+{
+	const float budgetMs = CVarApplyBudgetMs.GetValueOnGameThread();
+	if (budgetMs <= 0.f)
+	{
+		CommitTransformBuffer();
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_RTT_CommitTransforms);
+	SlicedCommitFrame = GFrameCounter;
+
+	const int32 numTransforms = TransformBuffer.Num();
+	if (SlicedCommitOrder.Num() != numTransforms)
+	{
+		//grouped by Attach Parent, so the Attach Space only changes between groups
+		SlicedCommitOrder.Reset(numTransforms);
+		SlicedCommitGroups.Reset(numTransforms);
+		for (int32 group = 0; group < TransformBuffer.AttachGroups.Num(); ++group)
+		{
+			for (int32 i : TransformBuffer.AttachGroups[group].Indices)
+			{
+				SlicedCommitOrder.Add(i);
+				SlicedCommitGroups.Add(group);
+			}
+		}
+		for (int32 i : TransformBuffer.WorldSpaceIndices)
+		{
+			SlicedCommitOrder.Add(i);
+			SlicedCommitGroups.Add(INDEX_NONE);
+		}
+		SlicedCommitCursor = 0;
+	}
+
+	const int32 numOrdered = SlicedCommitOrder.Num();
+	const uint64 endCycles = FPlatformTime::Cycles64() + (uint64)(budgetMs * 0.001 / FPlatformTime::GetSecondsPerCycle64());
+
+	//Reserved up front: the Components point to their scopes, so these must never be relocated
+	TArray<FScopedMovementUpdate> movementScopes;
+	if (bBatchTransformCommit)
+		movementScopes.Reserve(FMath::Min(NumLaggingTransforms, numOrdered));
+
+	TOptional<FSelectionAttachSpace> space;
+	int32 spaceGroup = INDEX_NONE;
+	int32 numCommitted = 0;
+
+	//the batched notifications only report the entries set in this slice
+	TArray<int32> committedIndices;
+
+	//Round-robin from where the last frame stopped, so every Component waits at most NumLagging / (Components per frame) frames
+	for (int32 visited = 0; visited < numOrdered && NumLaggingTransforms > 0; ++visited)
+	{
+		if (numCommitted > 0 && numCommitted % SlicedCommitGranularity == 0 && FPlatformTime::Cycles64() >= endCycles)
+			break;
+
+		const int32 position = SlicedCommitCursor;
+		SlicedCommitCursor = (SlicedCommitCursor + 1) % numOrdered;
+
+		const int32 i = SlicedCommitOrder[position];
+		if (TransformStaleSince[i] == 0) continue;
+		TransformStaleSince[i] = 0;
+		--NumLaggingTransforms;
+		++numCommitted;
+
+		USceneComponent* sc = TransformBuffer.Components[i];
+		if (!IsValid(sc)) continue;
+
+		const int32 group = SlicedCommitGroups[position];
+		if (group != INDEX_NONE && group != spaceGroup)
+		{
+			space.Emplace(TransformBuffer.AttachGroups[group]);
+			spaceGroup = group;
+		}
+		if (group != INDEX_NONE && space->bParentInvalid) continue;
+
+		if (bBatchTransformCommit)
+			movementScopes.Emplace(sc, EScopedUpdate::DeferredUpdates);
+		CommitTransformEntry(i, group != INDEX_NONE ? &space.GetValue() : nullptr);
+
+		if (bBatchFocusableNotifications)
+			committedIndices.Add(i);
+		if (bMaintainSpatialIndex)
+			SpatialIndexDirtyComponents.Add(sc);
+	}
+
+	//close the scopes in reverse order (this is where the deferred updates run), destroyed in place as in CommitTransformBuffer
+	for (int32 i = movementScopes.Num() - 1; i >= 0; --i)
+		movementScopes.RemoveAt(i, 1, EAllowShrinking::No);
+
+	if (committedIndices.Num() > 0)
+		NotifyFocusableBatches(&committedIndices);
+
+	UpdateLaggingStats();
+}
+
+int32 ATransformerActor::GetMaxStalenessFrames() const
+{
+	if (NumLaggingTransforms == 0 || SlicedCommitOrder.Num() == 0) return 0;
+
+	//Round-robin commits leave the entries ordered by staleness from the cursor on, so the first lagging one is the oldest
+	const int32 numOrdered = SlicedCommitOrder.Num();
+	for (int32 n = 0; n < numOrdered; ++n)
+	{
+		const uint64 staleSince = TransformStaleSince[SlicedCommitOrder[(SlicedCommitCursor + n) % numOrdered]];
+		if (staleSince != 0)
+			return (int32)(GFrameCounter + 1 - staleSince);
+	}
+	return 0;
+}
+
+void ATransformerActor::UpdateLaggingStats() const
+{
+	SET_DWORD_STAT(STAT_RTT_LaggingComponents, NumLaggingTransforms);
+	SET_DWORD_STAT(STAT_RTT_MaxStalenessFrames, GetMaxStalenessFrames());
+}
+
+void ATransformerActor::OnTransformBegin()
+{
+	if (bDeferOverlapsDuringTransform)
+	{
+		TArray<USceneComponent*> children;
+		for (const FSelectionHandle& handle : SelectedComponents)
+		{
+			USceneComponent* sc = handle.Get();
+			if (!sc) continue;
+			children.Reset();
+			sc->GetChildrenComponents(true, children);
+			children.Add(sc);
+			for (USceneComponent* child : children)
+			{
+				UPrimitiveComponent* primitive = Cast<UPrimitiveComponent>(child);
+				if (primitive && primitive->GetGenerateOverlapEvents())
+				{
+					primitive->SetGenerateOverlapEvents(false);
+					OverlapDeferredComponents.Add(primitive);
+				}
+			}
+		}
+	}
+}
+
+void ATransformerActor::OnTransformEnd()
+{
+	for (TWeakObjectPtr<UPrimitiveComponent>& primitive : OverlapDeferredComponents)
+	{
+		if (primitive.IsValid())
+		{
+			primitive->SetGenerateOverlapEvents(true);
+			primitive->UpdateOverlaps();
+		}
+	}
+	OverlapDeferredComponents.Reset();
+}
+
+void ATransformerActor::GatherSelectedTransforms()
+{
+	TransformBuffer.Reset();
+	UnappliedTransformIndices.Reset();
+	TransformFocusables.Reset();
+	SlicedCommitOrder.Reset();
+	SlicedCommitGroups.Reset();
+	TransformStaleSince.Reset();
+	if (NumLaggingTransforms > 0)
+	{
+		NumLaggingTransforms = 0;
+		UpdateLaggingStats();
+	}
+	TransformBuffer.Reserve(SelectedComponents.Num());
+
+	USceneComponent* firstUnmovable = nullptr;
+	int32 numUnmovable = 0;
+
+	//Adds the Component to the TransformBuffer if it can be moved. Returns whether we move it (and so its Nested Components)
+	auto gatherComponent = [&](const FSelectionHandle& handle)
+		{
+			USceneComponent* sc = handle.Get();
+			if (!sc) return false;
+
+			//only changed once: SetMobility recreates the Render State
+			if (bForceMobility && sc->Mobility != EComponentMobility::Type::Movable)
+				ForceMovable(handle, sc);
+
+			if (sc->Mobility != EComponentMobility::Type::Movable)
+			{
+				if (!UnmovableReportedComponents.Contains(handle))
+				{
+					UnmovableReportedComponents.Add(handle);
+					if (!firstUnmovable) firstUnmovable = sc;
+					++numUnmovable;
+				}
+				return false;
+			}
+
+			const int32 index = TransformBuffer.Add(sc, sc->GetComponentTransform());
+			const FCachedFocusable* focusable = FocusableCache.Find(handle);
+			TransformFocusables.Add(focusable ? *focusable : FCachedFocusable());
+			if (!bTransformUFocusableObjects && focusable)
+			{
+				UnappliedTransformIndices.Add(index);
+				return false;
+			}
+			return true;
+		};
+
+	//Roots first, in Selection order. Moving a Selected ancestor already moves its Nested Components, so these are
+	// only gathered if their closest Selected ancestor is not moved by us (not Movable, or a UFocusable we do not Transform)
+	TArray<FSelectionHandle> uncoveredComponents;
+	for (const FSelectionHandle& handle : SelectedComponents)
+	{
+		if (!HasSelectedAncestor(handle) && !gatherComponent(handle))
+			NestedSelectedChildren.MultiFind(handle, uncoveredComponents);
+	}
+	for (int32 i = 0; i < uncoveredComponents.Num(); ++i)
+	{
+		const FSelectionHandle handle = uncoveredComponents[i];
+		if (!gatherComponent(handle))
+			NestedSelectedChildren.MultiFind(handle, uncoveredComponents);
+	}
+
+	//a single report per Gather, and only for the Components not reported since they were Selected
+	if (numUnmovable == 1)
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Transform will not affect Component [%s] as it is NOT Moveable!"), *firstUnmovable->GetName());
+	}
+	else if (numUnmovable > 1)
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("Transform will not affect Component [%s] and %d others as they are NOT Moveable!"), *firstUnmovable->GetName(), numUnmovable - 1);
+	}
+
+	TransformBuffer.BuildAttachGroups();
+	bTransformBufferValid = true;
+
+	if (CurrentDomain == ETransformationDomain::TD_None) return;
+
+	//only the first gather of a Transform is its start, later ones (the Selection changed) continue frame by frame
+	if (!bDragStartValid)
+	{
+		DragStartBuffer = TransformBuffer;
+		bDragStartValid = true;
+		bDragStartAligned = true;
+		ResetDeltaTransform(DragTotalDelta);
+		DragPivot = Gizmo.IsValid() ? Gizmo->GetActorLocation() : FVector::ZeroVector;
+		bDragRotateOnLocalAxis = bRotateOnLocalAxis;
+	}
+	else
+		bDragStartAligned = false;
+}
+
+bool ATransformerActor::AccumulateDragDelta(const FTransform& Delta, const FVector& Pivot)
+{
+	const FQuat rotation = Delta.GetRotation();
+	const FQuat totalRotation = DragTotalDelta.GetRotation();
+	const bool bRotate = !rotation.Equals(FQuat::Identity, 0.0);
+	const bool bScale = !Delta.GetScale3D().IsZero();
+
+	//Delta Scale is unrotated by the Rotation the Components have at that moment,
+	// so Scaling after (or while) Rotating can't be applied to the start Transforms
+	if ((bScale && (bRotate || !totalRotation.Equals(FQuat::Identity, 0.0)))
+		|| (bRotate && !DragTotalDelta.GetScale3D().IsZero())
+		|| bRotateOnLocalAxis != bDragRotateOnLocalAxis)
+	{
+		bDragStartAligned = false;
+		return false;
+	}
+
+	//x = R(x0 - P0) + P0 + T, then x' = r(x - p) + p + t = rR(x0 - P0) + P0 + T'
+	FVector totalLocation = DragTotalDelta.GetLocation();
+	if (bRotate && !bRotateOnLocalAxis)
+		totalLocation = rotation.RotateVector(DragPivot + totalLocation - Pivot) + Pivot - DragPivot;
+	totalLocation += Delta.GetLocation();
+
+	DragTotalDelta.SetRotation((rotation * totalRotation).GetNormalized());
+	DragTotalDelta.SetLocation(totalLocation);
+	DragTotalDelta.SetScale3D(DragTotalDelta.GetScale3D() + Delta.GetScale3D());
+	return true;
+}
+
+void ATransformerActor::ForceMovable(const FSelectionHandle& Handle, USceneComponent* Component)
+{
+	//Movable Components can only have Movable children, so SetMobility changes the Descendants too
+	TArray<FForcedMobility, TInlineAllocator<1>>& forcedMobilities = ForcedMobilities.FindOrAdd(Handle);
+	forcedMobilities.Add({ Component, Component->Mobility });
+
+	TArray<USceneComponent*> descendants;
+	Component->GetChildrenComponents(true, descendants);
+	for (USceneComponent* descendant : descendants)
+	{
+		if (descendant->Mobility != EComponentMobility::Type::Movable)
+			forcedMobilities.Add({ descendant, descendant->Mobility });
+	}
+
+	Component->SetMobility(EComponentMobility::Type::Movable);
+}
+
+void ATransformerActor::RestoreMobility(const FSelectionHandle& Handle)
+{
+	TArray<FForcedMobility, TInlineAllocator<1>> forcedMobilities;
+	if (!ForcedMobilities.RemoveAndCopyValue(Handle, forcedMobilities) || !bRestoreMobilityOnDeselect) return;
+
+	//the pending (previewed or lagging) Transforms are committed while the Components can still be moved
+	InvalidateTransformBuffer();
+
+	//Parents first (they were recorded first), as a Static Component can't be attached to a Movable one
+	for (const FForcedMobility& forcedMobility : forcedMobilities)
+	{
+		if (USceneComponent* component = forcedMobility.Component.Get())
+			component->SetMobility(forcedMobility.Mobility);
+	}
+}
+
+void ATransformerActor::InvalidateTransformBuffer()
+{
+	//the Components have not received the previewed Transforms yet
+	if (bPreviewCommitPending)
+		EndTransformPreview();
+	//nor the ones a Time Sliced commit did not get to, so the whole Selection ends at the exact final Transform
+	else if (NumLaggingTransforms > 0)
+		CommitTransformBuffer();
+	bTransformBufferValid = false;
+}
+
+void ATransformerActor::BeginTransformPreview()
+{
+	const int32 numTransforms = TransformBuffer.Num();
+	bPreviewCommitPending = true;
+	bPreviewRigid = true;
+	PreviewRigidTransform = FTransform::Identity;
+
+	//the Gizmo is moved along with the previewed Transform of the Component it is attached to
+	PreviewGizmoAnchorIndex = INDEX_NONE;
+	if (Gizmo.IsValid())
+	{
+		PreviewGizmoStartRelativeTransform = Gizmo->GetRootComponent()->GetRelativeTransform();
+		PreviewGizmoAnchorIndex = TransformBuffer.Components.Find(Gizmo->GetRootComponent()->GetAttachParent());
+		if (PreviewGizmoAnchorIndex != INDEX_NONE)
+			PreviewGizmoOffset = Gizmo->GetActorTransform().GetRelativeTransform(TransformBuffer.GetTransform(PreviewGizmoAnchorIndex));
+	}
+
+	if (!PreviewProxyMesh) return;
+
+	if (!PreviewProxy)
+	{
+		PreviewProxy = NewObject<UInstancedStaticMeshComponent>(this, TEXT("PreviewProxy"));
+		PreviewProxy->SetUsingAbsoluteLocation(true);
+		PreviewProxy->SetUsingAbsoluteRotation(true);
+		PreviewProxy->SetUsingAbsoluteScale(true);
+		PreviewProxy->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		PreviewProxy->SetCastShadow(false);
+		PreviewProxy->RegisterComponent();
+	}
+	PreviewProxy->SetStaticMesh(PreviewProxyMesh);
+	if (PreviewProxyMaterial)
+		PreviewProxy->SetMaterial(0, PreviewProxyMaterial);
+	PreviewProxy->SetWorldTransform(FTransform::Identity);
+	PreviewProxy->ClearInstances();
+
+	//One box instance per Component, fit to its Local Bounds (Actor Bounds if we are Actor Based)
+	const FBoxSphereBounds meshBounds = PreviewProxyMesh->GetBounds();
+	const FVector meshExtent = meshBounds.BoxExtent.ComponentMax(FVector(UE_KINDA_SMALL_NUMBER));
+
+	PreviewProxyLocalBounds.SetNumUninitialized(numTransforms);
+	TArray<FTransform> instanceTransforms;
+	instanceTransforms.SetNumUninitialized(numTransforms);
+	for (int32 i = 0; i < numTransforms; ++i)
+	{
+		USceneComponent* sc = TransformBuffer.Components[i];
+		FBox localBox(FVector::ZeroVector, FVector::ZeroVector);
+		if (IsValid(sc))
+		{
+			AActor* owner = sc->GetOwner();
+			localBox = (!bComponentBased && owner && owner->GetRootComponent() == sc)
+				? owner->CalculateComponentsBoundingBoxInLocalSpace(true)
+				: sc->CalcBounds(FTransform::Identity).GetBox();
+		}
+
+		const FVector scale = localBox.GetExtent() / meshExtent;
+		PreviewProxyLocalBounds[i] = FTransform(FQuat::Identity, localBox.GetCenter() - meshBounds.Origin * scale, scale);
+		instanceTransforms[i] = PreviewProxyLocalBounds[i] * TransformBuffer.GetTransform(i);
+	}
+	PreviewProxy->AddInstances(instanceTransforms, false, true);
+	PreviewProxy->SetVisibility(true);
+}
+
+void ATransformerActor::UpdateTransformPreview(const FTransform& DeltaTransform, const FVector& Pivot)
+{
+	//Translations and Rotations around the Pivot move everything rigidly, so only the Proxy Component needs to move
+	const bool bRigidDelta = DeltaTransform.GetScale3D().IsZero()
+		&& (!bRotateOnLocalAxis || DeltaTransform.GetRotation().Equals(FQuat::Identity, 0.0));
+
+	if (PreviewProxy && PreviewProxy->GetInstanceCount() == TransformBuffer.Num())
+	{
+		if (bPreviewRigid && bRigidDelta)
+		{
+			const FQuat rotation = DeltaTransform.GetRotation();
+			PreviewRigidTransform = PreviewRigidTransform
+				* FTransform(rotation, Pivot + DeltaTransform.GetLocation() - rotation.RotateVector(Pivot));
+			PreviewProxy->SetWorldTransform(PreviewRigidTransform);
+		}
+		else
+		{
+			if (bPreviewRigid)
+			{
+				bPreviewRigid = false;
+				PreviewProxy->SetWorldTransform(FTransform::Identity);
+			}
+
+			TArray<FTransform> instanceTransforms;
+			instanceTransforms.SetNumUninitialized(TransformBuffer.Num());
+			ParallelFor(TransformBuffer.Num(), [&](int32 i)
+			{
+				instanceTransforms[i] = PreviewProxyLocalBounds[i] * TransformBuffer.GetTransform(i);
+			}, TransformBuffer.Num() < ParallelApplyThreshold || ParallelApplyThreshold <= 0);
+			PreviewProxy->BatchUpdateInstancesTransforms(0, instanceTransforms, true, true, true);
+		}
+	}
+
+	if (Gizmo.IsValid() && PreviewGizmoAnchorIndex != INDEX_NONE)
+	{
+		Gizmo->SetActorTransform(PreviewGizmoOffset * TransformBuffer.GetTransform(PreviewGizmoAnchorIndex));
+		if (CurrentSpaceType != ESpaceType::ST_Local)
+			Gizmo->UpdateGizmoSpace(CurrentSpaceType);
+	}
+}
+
+void ATransformerActor::EndTransformPreview()
+{
+	bPreviewCommitPending = false;
+
+	if (PreviewProxy)
+	{
+		PreviewProxy->ClearInstances();
+		PreviewProxy->SetVisibility(false);
+	}
+	PreviewProxyLocalBounds.Reset();
+
+	//put the Gizmo back where it was on its Component, so that it follows it when the Transforms are committed
+	if (Gizmo.IsValid() && PreviewGizmoAnchorIndex != INDEX_NONE)
+		Gizmo->GetRootComponent()->SetRelativeTransform(PreviewGizmoStartRelativeTransform);
+	PreviewGizmoAnchorIndex = INDEX_NONE;
+
+	CommitTransformBuffer();
+}
+
+void ATransformerActor::RebuildSpatialIndex()
+{
+	SCOPE_CYCLE_COUNTER(STAT_RTT_SpatialIndexUpdate);
+
+	DEC_DWORD_STAT_BY(STAT_RTT_SpatialIndexEntries, SpatialIndex.Num());
+	SpatialIndex.Empty();
+	SpatialIndexProxies.Reset();
+	SpatialIndexDirtyComponents.Reset();
+
+	if (!bMaintainSpatialIndex) return;
+
+	if (UWorld* world = GetWorld())
+	{
+		for (TActorIterator<AActor> it(world); it; ++it)
+			AddActorToSpatialIndex(*it);
+	}
+}
+
+void ATransformerActor::AddActorToSpatialIndex(AActor* Actor)
+{
+	//Gizmos and the Transformer itself (Preview Proxy) are never selected
+	if (!IsValid(Actor) || Actor == this || Actor->IsA<ABaseGizmo>()) return;
+
+	if (bComponentBased)
+	{
+		TInlineComponentArray<UPrimitiveComponent*> primitives(Actor);
+		for (UPrimitiveComponent* primitive : primitives)
+			AddComponentToSpatialIndex(primitive);
+	}
+	else if (IsSelectable(Actor, Actor->GetRootComponent()))
+	{
+		//Actor Based selects the Root Component, but it's the Primitives that have Bounds
+		TInlineComponentArray<UPrimitiveComponent*> primitives(Actor);
+		for (UPrimitiveComponent* primitive : primitives)
+			AddSpatialIndexProxy(primitive);
+	}
+}
+
+void ATransformerActor::AddComponentToSpatialIndex(UPrimitiveComponent* Primitive)
+{
+	if (IsValid(Primitive) && IsSelectable(Primitive->GetOwner(), Primitive))
+		AddSpatialIndexProxy(Primitive);
+}
+
+void ATransformerActor::AddSpatialIndexProxy(UPrimitiveComponent* Primitive)
+{
+	if (!IsValid(Primitive) || !Primitive->IsRegistered() || SpatialIndexProxies.Contains(Primitive)) return;
+
+	SpatialIndexProxies.Add(Primitive, SpatialIndex.CreateProxy(Primitive->Bounds.GetBox(), SpatialIndexMargin, Primitive));
+	INC_DWORD_STAT(STAT_RTT_SpatialIndexEntries);
+}
+
+void ATransformerActor::RemoveActorFromSpatialIndex(AActor* Actor)
+{
+	if (!Actor) return;
+
+	TInlineComponentArray<UPrimitiveComponent*> primitives(Actor);
+	for (UPrimitiveComponent* primitive : primitives)
+		RemoveComponentFromSpatialIndex(primitive);
+}
+
+void ATransformerActor::RemoveComponentFromSpatialIndex(UPrimitiveComponent* Primitive)
+{
+	int32 proxyId;
+	if (Primitive && SpatialIndexProxies.RemoveAndCopyValue(Primitive, proxyId))
+	{
+		SpatialIndex.DestroyProxy(proxyId);
+		DEC_DWORD_STAT(STAT_RTT_SpatialIndexEntries);
+	}
+}
+
+void ATransformerActor::FlushSpatialIndex()
+{
+	if (SpatialIndexDirtyComponents.Num() == 0) return;
+
+	SCOPE_CYCLE_COUNTER(STAT_RTT_SpatialIndexUpdate);
+
+	TArray<USceneComponent*> movedComponents;
+	for (const TWeakObjectPtr<USceneComponent>& dirtyComponent : SpatialIndexDirtyComponents)
+	{
+		USceneComponent* sc = dirtyComponent.Get();
+		if (!sc) continue;
+
+		movedComponents.Reset();
+		sc->GetChildrenComponents(true, movedComponents);
+		movedComponents.Add(sc);
+
+		for (USceneComponent* moved : movedComponents)
+		{
+			UPrimitiveComponent* primitive = Cast<UPrimitiveComponent>(moved);
+			if (const int32* proxyId = primitive ? SpatialIndexProxies.Find(primitive) : nullptr)
+				SpatialIndex.MoveProxy(*proxyId, primitive->Bounds.GetBox(), SpatialIndexMargin);
+		}
+	}
+	SpatialIndexDirtyComponents.Reset();
+}
+
+template<typename VisitorType>
+void ATransformerActor::QuerySpatialIndex(const FBox& Box, TSubclassOf<AActor> ActorClass, FName ActorTag, VisitorType&& Visitor)
+{
+	FlushSpatialIndex();
+
+	SCOPE_CYCLE_COUNTER(STAT_RTT_SpatialIndexQuery);
+
+	TArray<int32, TInlineAllocator<16>> staleProxies;
+	SpatialIndex.Query(Box, [&](int32 ProxyId)
+		{
+			UPrimitiveComponent* primitive = SpatialIndex.GetUserData(ProxyId).ResolveObjectPtr();
+			if (!IsValid(primitive) || !primitive->IsRegistered())
+			{
+				staleProxies.Add(ProxyId);
+				return true;
+			}
+
+			AActor* owner = primitive->GetOwner();
+			if (ActorClass && (!owner || !owner->IsA(ActorClass))) return true;
+			if (!ActorTag.IsNone() && (!owner || !owner->ActorHasTag(ActorTag))) return true;
+
+			Visitor(primitive);
+			return true;
+		});
+
+	//Components destroyed without going through the Transformer
+	for (int32 proxyId : staleProxies)
+	{
+		SpatialIndexProxies.Remove(SpatialIndex.GetUserData(proxyId));
+		SpatialIndex.DestroyProxy(proxyId);
+		DEC_DWORD_STAT(STAT_RTT_SpatialIndexEntries);
+	}
+}
 
-#if WITH_EDITOR
-void ATransformerActor::PostEditChangeProperty(struct FPropertyChangedEvent& PropertyChangedEvent)
+TArray<USceneComponent*> ATransformerActor::QuerySpatialIndexBox(const FBox& Box
+	, TSubclassOf<AActor> ActorClass, FName ActorTag)
 {
-    Super::PostEditChangeProperty(PropertyChangedEvent);
+	TArray<USceneComponent*> outComponents;
+	if (!bMaintainSpatialIndex) return outComponents;
 
-    FName PropertyName = PropertyChangedEvent.GetPropertyName();
-    FString PropertyNameString = PropertyName.ToString();
-    if (PropertyName != GET_MEMBER_NAME_CHECKED(ATransformerActor, Gizmo) && PropertyNameString.StartsWith(TEXT("Current"), ESearchCase::IgnoreCase))
-    {
-        UpdateGizmoPlacement();
-    }
+	TSet<USceneComponent*> addedRoots;
+	QuerySpatialIndex(Box, ActorClass, ActorTag, [&](UPrimitiveComponent* Primitive)
+		{
+			if (!Primitive->Bounds.GetBox().Intersect(Box)) return;
+
+			if (bComponentBased)
+				outComponents.Add(Primitive);
+			else if (USceneComponent* root = Primitive->GetOwner()->GetRootComponent())
+			{
+				bool bAlreadyAdded;
+				addedRoots.Add(root, &bAlreadyAdded);
+				if (!bAlreadyAdded) outComponents.Add(root);
+			}
+		});
+	return outComponents;
 }
-#endif
 
-FTransform ATransformerActor::UpdateTransform(const FVector& LookingVector
-                                             , const FVector& RayOrigin
-                                             , const FVector& RayDirection)
+TArray<USceneComponent*> ATransformerActor::QuerySpatialIndexRadius(const FVector& Center
+	, float Radius, TSubclassOf<AActor> ActorClass, FName ActorTag)
 {
-	FTransform deltaTransform;
-	deltaTransform.SetScale3D(FVector::ZeroVector);
-
-	if (!Gizmo.IsValid() || CurrentDomain == ETransformationDomain::TD_None)
-		return deltaTransform;
-
-	FVector rayEnd = RayOrigin + 1'000'000'00 * RayDirection;
+	TArray<USceneComponent*> outComponents;
+	if (!bMaintainSpatialIndex) return outComponents;
 
-	FTransform calcDeltaTransform = Gizmo->GetDeltaTransform(LookingVector, RayOrigin, rayEnd, CurrentDomain);
+	const float radiusSquared = Radius * Radius;
+	TSet<USceneComponent*> addedRoots;
+	QuerySpatialIndex(FBox(Center - FVector(Radius), Center + FVector(Radius)), ActorClass, ActorTag, [&](UPrimitiveComponent* Primitive)
+		{
+			if (Primitive->Bounds.ComputeSquaredDistanceFromBoxToPoint(Center) > radiusSquared) return;
 
-	//The delta transform we are actually going to apply (same if there is no Snapping taking place)
-	deltaTransform = calcDeltaTransform;
+			if (bComponentBased)
+				outComponents.Add(Primitive);
+			else if (USceneComponent* root = Primitive->GetOwner()->GetRootComponent())
+			{
+				bool bAlreadyAdded;
+				addedRoots.Add(root, &bAlreadyAdded);
+				if (!bAlreadyAdded) outComponents.Add(root);
+			}
+		});
+	return outComponents;
+}
 
-	/* SNAPPING LOGIC */
-	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
-	float* snappingValue = SnappingValues.Find(CurrentTransformation);
+void ATransformerActor::MarqueeSelect(const FVector2D& ScreenStart, const FVector2D& ScreenEnd
+	, bool bAppendToList, bool bRequireFullyInside)
+{
+	FMatrix viewProjection;
+	FIntRect viewRect;
+	if (!GetPlayerViewProjection(viewProjection, viewRect)) return;
+
+	FBox2D screenRect(ForceInit);
+	screenRect += ScreenStart;
+	screenRect += ScreenEnd;
+	MarqueeSelectInView(screenRect, viewProjection, viewRect, bAppendToList, bRequireFullyInside);
+}
 
-	if (snappingEnabled && *snappingEnabled && snappingValue)
-			deltaTransform = Gizmo->GetSnappedTransform(AccumulatedDeltaTransform
-				, calcDeltaTransform, CurrentDomain, *snappingValue);
-				//GetSnapped Transform Modifies Accumulated Delta Transform by how much Snapping Occurred
+void ATransformerActor::LassoSelect(const TArray<FVector2D>& ScreenPoints, bool bAppendToList)
+{
+	FMatrix viewProjection;
+	FIntRect viewRect;
+	if (!GetPlayerViewProjection(viewProjection, viewRect)) return;
 
-	ApplyDeltaTransform(deltaTransform);
-	return deltaTransform;
+	LassoSelectInView(ScreenPoints, viewProjection, viewRect, bAppendToList);
 }
 
-void ATransformerActor::ApplyDeltaTransform(const FTransform& DeltaTransform)
+void ATransformerActor::MarqueeSelectInView(const FBox2D& ScreenRect, const FMatrix& ViewProjection, const FIntRect& ViewRect
+	, bool bAppendToList, bool bRequireFullyInside)
 {
-	bool* snappingEnabled = SnappingEnabled.Find(CurrentTransformation);
-	float* snappingValue = SnappingValues.Find(CurrentTransformation);
+	TArray<int32> indices;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RTT_ScreenSelection);
+		GatherScreenSelectionCandidates(ViewProjection, ViewRect);
+		ScreenSelectionBuffer.GetInRect(ScreenRect, bRequireFullyInside, indices);
+	}
+	SelectScreenSelectionCandidates(indices, bAppendToList);
+}
 
-	for (auto& sc : SelectedComponents)
+void ATransformerActor::LassoSelectInView(TConstArrayView<FVector2D> ScreenPoints, const FMatrix& ViewProjection, const FIntRect& ViewRect
+	, bool bAppendToList)
+{
+	TArray<int32> indices;
 	{
-		if (!sc) continue;
-		if (bForceMobility || sc->Mobility == EComponentMobility::Type::Movable)
-		{
-			const FTransform& componentTransform = sc->GetComponentTransform();
+		SCOPE_CYCLE_COUNTER(STAT_RTT_ScreenSelection);
+		GatherScreenSelectionCandidates(ViewProjection, ViewRect);
+		ScreenSelectionBuffer.GetInPolygon(ScreenPoints, indices);
+	}
+	SelectScreenSelectionCandidates(indices, bAppendToList);
+}
 
-			FQuat deltaRotation = DeltaTransform.GetRotation();
+bool ATransformerActor::GetPlayerViewProjection(FMatrix& OutViewProjection, FIntRect& OutViewRect) const
+{
+	APlayerController* PlayerController = UGameplayStatics::GetPlayerController(this, 0);
+	ULocalPlayer* localPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+	if (!localPlayer || !localPlayer->ViewportClient || !localPlayer->ViewportClient->Viewport) return false;
 
-			FVector deltaLocation = componentTransform.GetLocation()
-				- Gizmo->GetActorLocation();
+	FSceneViewProjectionData projectionData;
+	if (!localPlayer->GetProjectionData(localPlayer->ViewportClient->Viewport, projectionData)) return false;
 
-			//DeltaScale is Unrotated Scale to Get Local Scale since World Scale is not supported
-			FVector deltaScale = componentTransform.GetRotation()
-				.UnrotateVector(DeltaTransform.GetScale3D());
+	OutViewProjection = projectionData.ComputeViewProjectionMatrix();
+	OutViewRect = projectionData.GetConstrainedViewRect();
+	return true;
+}
 
+void ATransformerActor::GatherScreenSelectionCandidates(const FMatrix& ViewProjection, const FIntRect& ViewRect)
+{
+	ScreenSelectionBuffer.Reset();
 
-			if (false == bRotateOnLocalAxis)
-				deltaLocation = deltaRotation.RotateVector(deltaLocation);
+	auto addCandidate = [this](UPrimitiveComponent* Primitive)
+		{
+			if (Primitive->IsRegistered() && Primitive->IsVisible())
+				ScreenSelectionBuffer.Add(Primitive, Primitive->Bounds);
+		};
 
-			FTransform newTransform(
-				deltaRotation * componentTransform.GetRotation(),
-				//adding Gizmo Location + prevDeltaLocation
-				// (i.e. location from Gizmo to Object after optional Rotating)
-				// + deltaTransform Location Offset
-				deltaLocation + Gizmo->GetActorLocation() + DeltaTransform.GetLocation(),
-				deltaScale + componentTransform.GetScale3D());
+	if (bMaintainSpatialIndex)
+	{
+		//the Spatial Index only has Selectable Primitives, so the whole of it are the candidates
+		const FBox everything(FVector(-UE_BIG_NUMBER), FVector(UE_BIG_NUMBER));
+		QuerySpatialIndex(everything, nullptr, NAME_None, [&](UPrimitiveComponent* Primitive)
+			{
+				AActor* owner = Primitive->GetOwner();
+				if (owner && !owner->IsHidden())
+					addCandidate(Primitive);
+			});
+	}
+	else if (UWorld* world = GetWorld())
+	{
+		for (TActorIterator<AActor> it(world); it; ++it)
+		{
+			AActor* actor = *it;
+			//Gizmos and the Transformer itself (Preview Proxy) are never selected
+			if (!IsValid(actor) || actor == this || actor->IsA<ABaseGizmo>() || actor->IsHidden()) continue;
+			if (!bComponentBased && !IsSelectable(actor, actor->GetRootComponent())) continue;
+
+			TInlineComponentArray<UPrimitiveComponent*> primitives(actor);
+			for (UPrimitiveComponent* primitive : primitives)
+				if (!bComponentBased || IsSelectable(actor, primitive))
+					addCandidate(primitive);
+		}
+	}
 
+	const bool bParallel = ParallelApplyThreshold > 0 && ScreenSelectionBuffer.Num() >= ParallelApplyThreshold;
+	ScreenSelectionBuffer.Project(ViewProjection, ViewRect, bParallel);
+}
 
-			/* SNAPPING LOGIC PER COMPONENT */
-			if (snappingEnabled && *snappingEnabled && snappingValue)
-				newTransform = Gizmo->GetSnappedTransformPerComponent(componentTransform
-					, newTransform, CurrentDomain, *snappingValue);
+void ATransformerActor::SelectScreenSelectionCandidates(const TArray<int32>& Indices, bool bAppendToList)
+{
+	if (Indices.Num() == 0)
+	{
+		//an empty Marquee / Lasso clears the Selection, like clicking on nothing
+		if (!bAppendToList) DeselectAll();
+		return;
+	}
 
-			sc->SetMobility(EComponentMobility::Type::Movable);
-			SetTransform(sc, newTransform);
-		}
-		else
+	if (bComponentBased)
+	{
+		TArray<USceneComponent*> components;
+		components.Reserve(Indices.Num());
+		for (int32 index : Indices)
+			components.Add(ScreenSelectionBuffer.Components[index]);
+		SelectMultipleComponents(components, bAppendToList);
+	}
+	else
+	{
+		//Actor Based has a candidate per Primitive, but selects each Actor once
+		TSet<AActor*> addedActors;
+		TArray<AActor*> actors;
+		for (int32 index : Indices)
 		{
-			UE_LOG(LogRuntimeTransformer, Warning, TEXT("Transform will not affect Component [%s] as it is NOT Moveable!"), *sc->GetName());
+			AActor* owner = ScreenSelectionBuffer.Components[index]->GetOwner();
+			if (!owner) continue;
+			bool bAlreadyAdded;
+			addedActors.Add(owner, &bAlreadyAdded);
+			if (!bAlreadyAdded) actors.Add(owner);
 		}
-
+		SelectMultipleActors(actors, bAppendToList);
 	}
 }
 
+bool ATransformerActor::PickGizmoDomain(const FVector& StartLocation, const FVector& EndLocation)
+{
+	if (!bAnalyticGizmoPicking || !Gizmo.IsValid()) return false;
+
+	float hitDistance;
+	const ETransformationDomain domain = Gizmo->TraceTransformationDomain(StartLocation, EndLocation, hitDistance);
+	if (domain == ETransformationDomain::TD_None) return false;
+
+	ClearDomain();
+	SetDomain(domain);
+	Gizmo->SetTransformProgressState(true, CurrentDomain);
+	return true;
+}
+
 bool ATransformerActor::HandleTracedObjects(const TArray<FHitResult>& HitResults, bool bAppendToList)
 {
 	//Assign as None just in case we don't hit Any Gizmos
@@ -499,8 +1898,15 @@ bool ATransformerActor::HandleTracedObjects(const TArray<FHitResult>& HitResults
 
 void ATransformerActor::SetComponentBased(bool bIsComponentBased)
 {
+	FScopedSelectionTransaction transaction(this);
 	auto selectedComponents = DeselectAll();
+	const bool bChanged = bComponentBased != bIsComponentBased;
 	bComponentBased = bIsComponentBased;
+
+	//Actor Based and Component Based index different Components
+	if (bChanged && bMaintainSpatialIndex && HasActorBegunPlay())
+		RebuildSpatialIndex();
+
 	if(bComponentBased)
 		SelectMultipleComponents(selectedComponents, false);
 	else
@@ -533,6 +1939,7 @@ void ATransformerActor::SetTransformationType(ETransformationType Transformation
 
 	//Clear the Accumulated tranform when we have a new Transformation
 	ResetDeltaTransform(AccumulatedDeltaTransform);
+	InvalidateTransformBuffer();
 
 	UpdateGizmoPlacement();
 }
@@ -550,14 +1957,17 @@ void ATransformerActor::SetSnappingValue(ETransformationType TransformationType,
 void ATransformerActor::GetSelectedComponents(TArray<class USceneComponent*>& outComponentList
 	, USceneComponent*& outGizmoPlacedComponent) const
 {
-	outComponentList = SelectedComponents;
+	outComponentList.Reset();
+	ResolveSelectedComponents(outComponentList);
 	if (Gizmo.IsValid())
 		outGizmoPlacedComponent = Gizmo->GetParentComponent();
 }
 
 TArray<USceneComponent*> ATransformerActor::GetSelectedComponents() const
 {
-	return SelectedComponents;
+	TArray<USceneComponent*> components;
+	ResolveSelectedComponents(components);
+	return components;
 }
 
 void ATransformerActor::CloneSelected(bool bSelectNewClones
@@ -569,7 +1979,9 @@ void ATransformerActor::CloneSelected(bool bSelectNewClones
     }
 
 
-	auto CloneComponents = CloneFromList(SelectedComponents);
+	TArray<USceneComponent*> selectedComponents;
+	ResolveSelectedComponents(selectedComponents);
+	auto CloneComponents = CloneFromList(selectedComponents);
 
 	if (bSelectNewClones)
 		SelectMultipleComponents(CloneComponents, bAppendToList);
@@ -603,6 +2015,13 @@ TArray<class USceneComponent*> ATransformerActor::CloneFromList(const TArray<USc
 	if (CurrentDomain != ETransformationDomain::TD_None && Gizmo.IsValid())
 		Gizmo->SetTransformProgressState(true, CurrentDomain);
 
+	//Cloned Actors are added when spawned, but Cloned Components have to be added here
+	if (bMaintainSpatialIndex && bComponentBased)
+	{
+		for (USceneComponent* clone : outClones)
+			AddComponentToSpatialIndex(Cast<UPrimitiveComponent>(clone));
+	}
+
 	return outClones;
 }
 
@@ -737,14 +2156,15 @@ void ATransformerActor::SelectComponent(class USceneComponent* Component, bool b
 {
 	if (!Component) return;
 
-	if (ShouldSelect(Component->GetOwner(), Component))
+	if (IsSelectable(Component->GetOwner(), Component))
 	{
+		FScopedSelectionTransaction transaction(this);
 		if (bAppendToList == false)
 		{
 			DeselectAll();
 		}
 		AddComponent_Internal(SelectedComponents, Component);
-		UpdateGizmoPlacement();
+		FlushSelectionChange();
 	}
 }
 
@@ -753,24 +2173,36 @@ void ATransformerActor::SelectActor(AActor* Actor
 {
 	if (!Actor) return;
 
-	if (ShouldSelect(Actor, Actor->GetRootComponent()))
+	if (IsSelectable(Actor, Actor->GetRootComponent()))
 	{
+		FScopedSelectionTransaction transaction(this);
 		if (false == bAppendToList)
 			DeselectAll();
 		AddComponent_Internal(SelectedComponents, Actor->GetRootComponent());
-		UpdateGizmoPlacement();
+		FlushSelectionChange();
 	}
 }
 
 void ATransformerActor::SelectMultipleComponents(const TArray<USceneComponent*>& Components
 	, bool bAppendToList)
 {
+	SCOPE_CYCLE_COUNTER(STAT_RTT_SelectComponents);
+	FScopedSelectionTransaction transaction(this);
 	bool bValidList = false;
 
-	for (auto& c : Components)
+	//the Filter runs on the whole list at once
+	TArray<AActor*> owners;
+	owners.Reserve(Components.Num());
+	for (USceneComponent* c : Components)
+		owners.Add(c ? c->GetOwner() : nullptr);
+	TArray<ESelectionFilterResult> filterResults;
+	SelectionFilter.Evaluate(owners, Components, filterResults);
+
+	for (int32 i = 0; i < Components.Num(); ++i)
 	{
+		USceneComponent* c = Components[i];
 		if (!c) continue;
-		if (!ShouldSelect(c->GetOwner(), c)) continue;
+		if (!ResolveSelectionFilterResult(filterResults[i], owners[i], c)) continue;
 
 		if (false == bAppendToList)
 		{
@@ -778,21 +2210,35 @@ void ATransformerActor::SelectMultipleComponents(const TArray<USceneComponent*>&
 			bAppendToList = true;
 			//only run once. This is not place outside in case a list is empty or contains only invalid components
 		}
+		if (!bValidList)
+			SelectedComponents.Reserve(SelectedComponents.Num() + Components.Num());
 		bValidList = true;
 		AddComponent_Internal(SelectedComponents, c);
 	}
 
-	if(bValidList) UpdateGizmoPlacement();
+	if(bValidList) FlushSelectionChange();
 }
 
 void ATransformerActor::SelectMultipleActors(const TArray<AActor*>& Actors
 	, bool bAppendToList)
 {
+	SCOPE_CYCLE_COUNTER(STAT_RTT_SelectComponents);
+	FScopedSelectionTransaction transaction(this);
 	bool bValidList = false;
-	for (auto& a : Actors)
+
+	//the Filter runs on the whole list at once
+	TArray<USceneComponent*> roots;
+	roots.Reserve(Actors.Num());
+	for (AActor* a : Actors)
+		roots.Add(a ? a->GetRootComponent() : nullptr);
+	TArray<ESelectionFilterResult> filterResults;
+	SelectionFilter.Evaluate(Actors, roots, filterResults);
+
+	for (int32 i = 0; i < Actors.Num(); ++i)
 	{
+		AActor* a = Actors[i];
 		if (!a) continue;
-		if (!ShouldSelect(a, a->GetRootComponent())) continue;
+		if (!ResolveSelectionFilterResult(filterResults[i], a, roots[i])) continue;
 
 		if (false == bAppendToList)
 		{
@@ -801,17 +2247,123 @@ void ATransformerActor::SelectMultipleActors(const TArray<AActor*>& Actors
 			//only run once. This is not place outside in case a list is empty or contains only invalid components
 		}
 
+		if (!bValidList)
+			SelectedComponents.Reserve(SelectedComponents.Num() + Actors.Num());
 		bValidList = true;
 		AddComponent_Internal(SelectedComponents, a->GetRootComponent());
 	}
-	if(bValidList) UpdateGizmoPlacement();
+	if(bValidList) FlushSelectionChange();
+}
+
+void ATransformerActor::SetSelectionFilterRules(const FSelectionFilterRules& Rules)
+{
+	SelectionFilterRules = Rules;
+	SelectionFilter.SetRules(Rules);
+	if (bMaintainSpatialIndex)
+		RebuildSpatialIndex();
+}
+
+void ATransformerActor::FilterSelectableComponents(const TArray<USceneComponent*>& Components
+	, TArray<USceneComponent*>& OutSelectableComponents)
+{
+	TArray<AActor*> owners;
+	owners.Reserve(Components.Num());
+	for (USceneComponent* c : Components)
+		owners.Add(c ? c->GetOwner() : nullptr);
+
+	TArray<ESelectionFilterResult> filterResults;
+	SelectionFilter.Evaluate(owners, Components, filterResults);
+
+	OutSelectableComponents.Reset();
+	for (int32 i = 0; i < Components.Num(); ++i)
+	{
+		if (Components[i] && ResolveSelectionFilterResult(filterResults[i], owners[i], Components[i]))
+			OutSelectableComponents.Add(Components[i]);
+	}
+}
+
+bool ATransformerActor::IsSelectable(AActor* OwnerActor, USceneComponent* Component)
+{
+	return ResolveSelectionFilterResult(SelectionFilter.Evaluate(OwnerActor, Component), OwnerActor, Component);
+}
+
+bool ATransformerActor::ResolveSelectionFilterResult(ESelectionFilterResult Result, AActor* OwnerActor, USceneComponent* Component)
+{
+	switch (Result)
+	{
+	case ESelectionFilterResult::Select:
+		return true;
+	case ESelectionFilterResult::Reject:
+		return false;
+	case ESelectionFilterResult::Undecided:
+		if (!bCallShouldSelectByDefault) return true;
+		break;
+	default:
+		break;
+	}
+
+	//without a Blueprint override, ShouldSelect would only run the native implementation anyway
+	return bShouldSelectInScript ? ShouldSelect(OwnerActor, Component) : ShouldSelect_Implementation(OwnerActor, Component);
+}
+
+void ATransformerActor::ApplySelectionChange(const TArray<USceneComponent*>& ComponentsToAdd
+	, const TArray<USceneComponent*>& ComponentsToRemove)
+{
+	FScopedSelectionTransaction transaction(this);
+	bool bChanged = false;
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RTT_DeselectComponents);
+		for (auto& c : ComponentsToRemove)
+		{
+			if (!c || !SelectedComponents.Contains(c)) continue;
+			DeselectComponent_Internal(SelectedComponents, c);
+			bChanged = true;
+		}
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RTT_SelectComponents);
+		SelectedComponents.Reserve(SelectedComponents.Num() + ComponentsToAdd.Num());
+		for (auto& c : ComponentsToAdd)
+		{
+			//Adding is not a toggle here: components already selected are left as they are
+			if (!c || SelectedComponents.Contains(c)) continue;
+			if (!IsSelectable(c->GetOwner(), c)) continue;
+			AddComponent_Internal(SelectedComponents, c);
+			bChanged = true;
+		}
+	}
+
+	if (bChanged) FlushSelectionChange();
+}
+
+void ATransformerActor::BeginSelectionTransaction()
+{
+	++SelectionTransactionDepth;
+}
+
+void ATransformerActor::CommitSelectionTransaction()
+{
+	if (SelectionTransactionDepth <= 0)
+	{
+		UE_LOG(LogRuntimeTransformer, Warning, TEXT("CommitSelectionTransaction called without a matching BeginSelectionTransaction!"));
+		return;
+	}
+
+	if (--SelectionTransactionDepth == 0 && bSelectionChangePending)
+	{
+		bSelectionChangePending = false;
+		UpdateGizmoPlacement();
+		BroadcastSelectionSetChanged();
+	}
 }
 
 void ATransformerActor::DeselectComponent(USceneComponent* Component)
 {
 	if (!Component) return;
 	DeselectComponent_Internal(SelectedComponents, Component);
-	UpdateGizmoPlacement();
+	FlushSelectionChange();
 }
 
 void ATransformerActor::DeselectActor(AActor* Actor)
@@ -822,12 +2374,22 @@ void ATransformerActor::DeselectActor(AActor* Actor)
 
 TArray<USceneComponent*> ATransformerActor::DeselectAll(bool bDestroyDeselected)
 {
-	TArray<USceneComponent*> componentsToDeselect = SelectedComponents;
+	SCOPE_CYCLE_COUNTER(STAT_RTT_DeselectComponents);
+	TArray<USceneComponent*> componentsToDeselect;
+	ResolveSelectedComponents(componentsToDeselect);
 	for (auto& i : componentsToDeselect)
-		DeselectComponent(i);
-		//calling internal so as not to modify SelectedComponents until the last bit!
+		DeselectComponent_Internal(SelectedComponents, i);
+		//calling internal so that the Gizmo is only updated once, at the end
+	DEC_DWORD_STAT_BY(STAT_RTT_NumSelected, SelectedComponents.Num()); //the destroyed ones left
 	SelectedComponents.Empty();
-	UpdateGizmoPlacement();
+	SelectionHierarchy.Empty();
+	NestedSelectedChildren.Empty();
+	SelectedRoots.Empty();
+	FocusableCache.Empty();
+	ForcedMobilities.Empty();
+	UnmovableReportedComponents.Empty();
+	StreamedOutSelection.Empty();
+	FlushSelectionChange();
 
 	if (bDestroyDeselected)
 	{
@@ -838,7 +2400,10 @@ TArray<USceneComponent*> ATransformerActor::DeselectAll(bool bDestroyDeselected)
 			{
 				//We destroy the actor if no components are left to destroy, or the system is currently ActorBased
 				if (bComponentBased && actor->GetComponents().Num() > 1)
+				{
+					RemoveComponentFromSpatialIndex(Cast<UPrimitiveComponent>(c));
 					c->DestroyComponent(true);
+				}
 				else
 					actor->Destroy();
 			}
@@ -848,62 +2413,245 @@ TArray<USceneComponent*> ATransformerActor::DeselectAll(bool bDestroyDeselected)
 	return componentsToDeselect;
 }
 
-void ATransformerActor::AddComponent_Internal(TArray<USceneComponent*>& OutComponentList
+void ATransformerActor::AddComponent_Internal(TOrderedSelectionSet<FSelectionHandle>& OutComponentList
 	, USceneComponent* Component)
 {
 	//if (!Component) return; //assumes that previous have checked, since this is Internal.
 
-	int32 Index = OutComponentList.Find(Component);
-
-	if (INDEX_NONE == Index) //Component is not in list
+	if (OutComponentList.Add(Component)) //Component was not in list
 	{
-		OutComponentList.Emplace(Component);
 		bool bImplementsInterface;
-		Select(OutComponentList.Last(), &bImplementsInterface);
-		OnComponentSelectionChange(Component, true, bImplementsInterface);
+		Select(Component, &bImplementsInterface);
+		UpdateSelectionHierarchy(Component, true);
+		RecordSelectionChange(Component, true);
+		if (bBroadcastPerComponentSelectionChange)
+			OnComponentSelectionChange(Component, true, bImplementsInterface);
+		INC_DWORD_STAT(STAT_RTT_NumSelected);
 	}
 	else if (bToggleSelectedInMultiSelection)
-		DeselectComponentAtIndex_Internal(OutComponentList, Index);
+		DeselectComponent_Internal(OutComponentList, Component);
 }
 
-void ATransformerActor::DeselectComponent_Internal(TArray<USceneComponent*>& OutComponentList
+void ATransformerActor::DeselectComponent_Internal(TOrderedSelectionSet<FSelectionHandle>& OutComponentList
 	, USceneComponent* Component)
 {
 	//if (!Component) return; //assumes that previous have checked, since this is Internal.
 
-	int32 Index = OutComponentList.Find(Component);
-	if (INDEX_NONE != Index)
-		DeselectComponentAtIndex_Internal(OutComponentList, Index);
+	if (OutComponentList.Contains(Component))
+	{
+		bool bImplementsInterface;
+		Deselect(Component, &bImplementsInterface);
+		OutComponentList.Remove(Component);
+		UpdateSelectionHierarchy(Component, false);
+		RecordSelectionChange(Component, false);
+		if (bBroadcastPerComponentSelectionChange)
+			OnComponentSelectionChange(Component, false, bImplementsInterface);
+		DEC_DWORD_STAT(STAT_RTT_NumSelected);
+	}
 }
 
-void ATransformerActor::DeselectComponentAtIndex_Internal(
-	TArray<USceneComponent*>& OutComponentList
-	, int32 Index)
+bool ATransformerActor::HasSelectedAncestor(const FSelectionHandle& Component) const
 {
-	//if (!Component) return; //assumes that previous have checked, since this is Internal.
-	if (OutComponentList.IsValidIndex(Index))
+	const FSelectionHierarchyNode* node = SelectionHierarchy.Find(Component);
+	return node && !node->Ancestor.IsExplicitlyNull();
+}
+
+void ATransformerActor::UpdateSelectionHierarchy(USceneComponent* Component, bool bSelected)
+{
+	if (!bSelected)
 	{
-		USceneComponent* Component = OutComponentList[Index];
-		bool bImplementsInterface;
-		Deselect(Component, &bImplementsInterface);
-		OutComponentList.RemoveAt(Index);
-		OnComponentSelectionChange(Component, false, bImplementsInterface);
+		FSelectionHierarchyNode node;
+		if (!SelectionHierarchy.RemoveAndCopyValue(Component, node)) return;
+		UnlinkSelectionNode(Component, node);
+
+		//the Components it Nested are now Nested by its own closest Selected ancestor (or are Roots), nothing else changes
+		TArray<FSelectionHandle> nestedComponents;
+		NestedSelectedChildren.MultiFind(Component, nestedComponents);
+		NestedSelectedChildren.Remove(Component);
+		for (const FSelectionHandle& nested : nestedComponents)
+		{
+			FSelectionHierarchyNode& nestedNode = SelectionHierarchy.FindChecked(nested);
+			nestedNode.Ancestor = node.Ancestor;
+			LinkSelectionNode(nested, nestedNode);
+		}
+		return;
+	}
+
+	FSelectionHierarchyNode node;
+	ResolveSelectionNode(Component, node);
+
+	//The Components below this one were Nested by the same ancestor (or were Roots of the same hierarchy), so only those are checked
+	if (Component->GetNumChildrenComponents() > 0)
+	{
+		TArray<FSelectionHandle> candidates;
+		if (!node.Ancestor.IsExplicitlyNull())
+			NestedSelectedChildren.MultiFind(node.Ancestor, candidates);
+		else
+			SelectedRoots.MultiFind(node.AttachRoot, candidates);
+
+		for (const FSelectionHandle& candidate : candidates)
+		{
+			FSelectionHierarchyNode& candidateNode = SelectionHierarchy.FindChecked(candidate);
+			USceneComponent* candidateComponent = candidate.Get();
+			if (!candidateComponent || candidateNode.Depth <= node.Depth || !candidateComponent->IsAttachedTo(Component)) continue;
+
+			UnlinkSelectionNode(candidate, candidateNode);
+			candidateNode.Ancestor = Component;
+			LinkSelectionNode(candidate, candidateNode);
+		}
 	}
 
+	SelectionHierarchy.Add(Component, node);
+	LinkSelectionNode(Component, node);
 }
 
-ABaseGizmo* ATransformerActor::CreateGizmo(ETransformationType transformationType)
+void ATransformerActor::ResolveSelectionNode(USceneComponent* Component, FSelectionHierarchyNode& OutNode) const
 {
-    ABaseGizmo* gizmo = nullptr;
-    if (UWorld* world = GetWorld())
-    {
-        if (UClass* GizmoClass = GetGizmoClass(transformationType))
-        {
-            gizmo = Cast<ABaseGizmo>(world->SpawnActor(GizmoClass));
-            gizmo->OnGizmoStateChange.AddDynamic(this, &ATransformerActor::OnGizmoStateChanged);
-        }
-    }
-    return gizmo;
+	//a single walk up the attachment hierarchy
+	OutNode = FSelectionHierarchyNode();
+	OutNode.AttachRoot = Component;
+	for (USceneComponent* parent = Component->GetAttachParent(); parent; parent = parent->GetAttachParent())
+	{
+		if (OutNode.Ancestor.IsExplicitlyNull() && SelectedComponents.Contains(parent))
+			OutNode.Ancestor = parent;
+		OutNode.AttachRoot = parent;
+		++OutNode.Depth;
+	}
+}
+
+void ATransformerActor::LinkSelectionNode(const FSelectionHandle& Component, const FSelectionHierarchyNode& Node)
+{
+	if (!Node.Ancestor.IsExplicitlyNull())
+		NestedSelectedChildren.Add(Node.Ancestor, Component);
+	else
+		SelectedRoots.Add(Node.AttachRoot, Component);
+}
+
+void ATransformerActor::UnlinkSelectionNode(const FSelectionHandle& Component, const FSelectionHierarchyNode& Node)
+{
+	if (!Node.Ancestor.IsExplicitlyNull())
+		NestedSelectedChildren.RemoveSingle(Node.Ancestor, Component);
+	else
+		SelectedRoots.RemoveSingle(Node.AttachRoot, Component);
+}
+
+void ATransformerActor::ResolveSelectedComponents(TArray<USceneComponent*>& OutComponents) const
+{
+	OutComponents.Reserve(OutComponents.Num() + SelectedComponents.Num());
+	for (const FSelectionHandle& handle : SelectedComponents)
+	{
+		if (USceneComponent* component = handle.Get())
+			OutComponents.Add(component);
+	}
+}
+
+void ATransformerActor::PruneInvalidSelection()
+{
+	if (SelectionValidationFrame == GFrameCounter) return;
+	SelectionValidationFrame = GFrameCounter;
+
+	TArray<FSelectionHandle, TInlineAllocator<16>> invalidHandles;
+	for (const FSelectionHandle& handle : SelectedComponents)
+	{
+		if (!handle.IsValid())
+			invalidHandles.Add(handle);
+	}
+	if (invalidHandles.Num() == 0) return;
+
+	//there is no Component left to Deselect (or to pass to the Selection Events), the entries are just dropped
+	TArray<FSelectionHandle> orphanedComponents;
+	for (const FSelectionHandle& handle : invalidHandles)
+	{
+		SelectedComponents.Remove(handle);
+		FocusableCache.Remove(handle);
+		ForcedMobilities.Remove(handle);
+		UnmovableReportedComponents.Remove(handle);
+		PendingSelectedComponents.Remove(handle);
+
+		FSelectionHierarchyNode node;
+		if (SelectionHierarchy.RemoveAndCopyValue(handle, node))
+		{
+			UnlinkSelectionNode(handle, node);
+			NestedSelectedChildren.MultiFind(handle, orphanedComponents);
+			NestedSelectedChildren.Remove(handle);
+		}
+	}
+	DEC_DWORD_STAT_BY(STAT_RTT_NumSelected, invalidHandles.Num());
+
+	//the Components Nested by a destroyed one were re-attached elsewhere (or detached), so their place is found again
+	for (const FSelectionHandle& orphan : orphanedComponents)
+	{
+		FSelectionHierarchyNode* node = SelectionHierarchy.Find(orphan);
+		USceneComponent* sc = orphan.Get();
+		if (!node || !sc) continue;
+
+		ResolveSelectionNode(sc, *node);
+		LinkSelectionNode(orphan, *node);
+	}
+
+	InvalidateTransformBuffer();
+	++SelectionRevision;
+	FlushSelectionChange();
+}
+
+void ATransformerActor::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld() || SelectedComponents.IsEmpty()) return;
+
+	//a null Level means every Level of the World is being removed
+	TArray<USceneComponent*> streamedOut;
+	for (const FSelectionHandle& handle : SelectedComponents)
+	{
+		USceneComponent* component = handle.Get();
+		if (component && (!Level || component->GetComponentLevel() == Level))
+			streamedOut.Add(component);
+	}
+	if (streamedOut.Num() == 0) return;
+
+	FScopedSelectionTransaction transaction(this);
+	for (USceneComponent* component : streamedOut)
+	{
+		StreamedOutSelection.Add(FSoftObjectPath(component));
+		DeselectComponent_Internal(SelectedComponents, component);
+	}
+	FlushSelectionChange();
+}
+
+void ATransformerActor::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	if (World != GetWorld() || StreamedOutSelection.Num() == 0) return;
+
+	TArray<USceneComponent*> streamedIn;
+	for (int32 i = StreamedOutSelection.Num() - 1; i >= 0; --i)
+	{
+		if (USceneComponent* component = Cast<USceneComponent>(StreamedOutSelection[i].ResolveObject()))
+		{
+			streamedIn.Add(component);
+			StreamedOutSelection.RemoveAtSwap(i, 1, EAllowShrinking::No);
+		}
+	}
+
+	if (streamedIn.Num() > 0)
+		ApplySelectionChange(streamedIn, TArray<USceneComponent*>());
+}
+
+void ATransformerActor::OnPostGarbageCollect()
+{
+	//the Selection itself is weak (see PruneInvalidSelection), but the Transform Buffers would be read after their Components were freed
+	TransformBuffer.RemoveDestroyedComponents();
+	DragStartBuffer.RemoveDestroyedComponents();
+}
+
+UGizmoPoolSubsystem* ATransformerActor::GetGizmoPool() const
+{
+	UWorld* world = GetWorld();
+	return world ? world->GetSubsystem<UGizmoPoolSubsystem>() : nullptr;
+}
+
+UMeshPickingSubsystem* ATransformerActor::GetMeshPicking() const
+{
+	UWorld* world = GetWorld();
+	return world ? world->GetSubsystem<UMeshPickingSubsystem>() : nullptr;
 }
 
 void ATransformerActor::SetGizmo()
@@ -921,27 +2669,25 @@ void ATransformerActor::SetGizmo()
 			}
 			else
 			{
-				// Destroy the current gizmo as the transformation types do not match
+				// Release the current gizmo as the transformation types do not match
 			    ResetGizmo();
 			}
 		}
 
-		if (bCreateGizmo)
+		//the Gizmo is created once its Class finishes loading (see OnGizmoClassesLoaded)
+		if (bCreateGizmo && RequestGizmoClasses())
 		{
-		    int32 index = static_cast<int32>(CurrentTransformation);
-		    if (GizmoActorPool.IsValidIndex(index) && GizmoActorPool[index].IsValid())
-            {
-                Gizmo = GizmoActorPool[index];
-		        Gizmo->SetActorHiddenInGame(false);
-		        Gizmo->SetActorTickEnabled(true);
-		        Gizmo->SetActorEnableCollision(true);
-            }
-            else
-            {
-                Gizmo = CreateGizmo(CurrentTransformation);
-                GizmoActorPool.SetNum(index + 1);
-                GizmoActorPool[index] = Gizmo;
-            }
+		    UGizmoPoolSubsystem* gizmoPool = GetGizmoPool();
+		    ABaseGizmo* gizmo = gizmoPool ? gizmoPool->LeaseGizmo(GetGizmoClass(CurrentTransformation)) : nullptr;
+		    if (gizmo)
+		    {
+		        gizmo->OnGizmoStateChange.AddDynamic(this, &ATransformerActor::OnGizmoStateChanged);
+		        //Analytic Picking does not need the Gizmo in the Physics Scene
+		        gizmo->SetActorEnableCollision(bGizmoCollision);
+		        Gizmo = gizmo;
+		    }
+		    MarkViewDirty();
+		    RefreshTickState();
 		}
 	}
 	//Since there are no selected components, we must destroy any gizmos present
@@ -955,14 +2701,68 @@ void ATransformerActor::ResetGizmo()
 {
     if (Gizmo.IsValid())
     {
-        Gizmo->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
-        Gizmo->SetActorHiddenInGame(true);
-        Gizmo->SetActorTickEnabled(false);
-        Gizmo->SetActorEnableCollision(false);
+        Gizmo->OnGizmoStateChange.RemoveDynamic(this, &ATransformerActor::OnGizmoStateChanged);
+        if (UGizmoPoolSubsystem* gizmoPool = GetGizmoPool())
+            gizmoPool->ReleaseGizmo(Gizmo.Get());
         Gizmo.Reset();
+        RefreshTickState();
     }
 }
 
+void ATransformerActor::FlushSelectionChange()
+{
+	if (SelectionTransactionDepth > 0)
+		bSelectionChangePending = true;
+	else
+	{
+		UpdateGizmoPlacement();
+		BroadcastSelectionSetChanged();
+	}
+}
+
+void ATransformerActor::RecordSelectionChange(USceneComponent* Component, bool bSelected)
+{
+	InvalidateTransformBuffer();
+	++SelectionRevision;
+
+	//a Component selected and deselected within the same operation cancels out
+	if (bSelected)
+	{
+		if (!PendingDeselectedComponents.Remove(Component))
+			PendingSelectedComponents.Add(Component);
+	}
+	else
+	{
+		if (!PendingSelectedComponents.Remove(Component))
+			PendingDeselectedComponents.Add(Component);
+	}
+}
+
+void ATransformerActor::BroadcastSelectionSetChanged()
+{
+	if (PendingSelectedComponents.IsEmpty() && PendingDeselectedComponents.IsEmpty()) return;
+
+	if (OnSelectionSetChanged.IsBound() || OnSelectionSetChangedNative.IsBound())
+	{
+		//Components destroyed before the broadcast are left out
+		TArray<USceneComponent*> added, removed;
+		for (const FSelectionHandle& handle : PendingSelectedComponents)
+			if (USceneComponent* component = handle.Get()) added.Add(component);
+		for (const FSelectionHandle& handle : PendingDeselectedComponents)
+			if (USceneComponent* component = handle.Get()) removed.Add(component);
+		PendingSelectedComponents.Empty();
+		PendingDeselectedComponents.Empty();
+
+		OnSelectionSetChangedNative.Broadcast(added, removed);
+		OnSelectionSetChanged.Broadcast(added, removed);
+	}
+	else
+	{
+		PendingSelectedComponents.Empty();
+		PendingDeselectedComponents.Empty();
+	}
+}
+
 void ATransformerActor::UpdateGizmoPlacement()
 {
 	SetGizmo();
@@ -974,18 +2774,21 @@ void ATransformerActor::UpdateGizmoPlacement()
 	switch (GizmoPlacement)
 	{
 	case EGizmoPlacement::GP_OnFirstSelection:
-		ComponentToAttachTo = SelectedComponents[0]; break;
+		ComponentToAttachTo = SelectedComponents.First().Get(); break;
 	case EGizmoPlacement::GP_OnLastSelection:
-		ComponentToAttachTo = SelectedComponents.Last(); break;
+		ComponentToAttachTo = SelectedComponents.Last().Get(); break;
 	case EGizmoPlacement::GP_None:
 	    UE_LOG(LogRuntimeTransformer, Warning, TEXT("Gizmo Placement is None! setting to last selection"));
-	    ComponentToAttachTo = SelectedComponents.Last(); break;
+	    ComponentToAttachTo = SelectedComponents.Last().Get(); break;
 	}
 
 	if (ComponentToAttachTo)
 	{
 	    FName socketToAttach = AttachSocketName.IsNone() == false && ComponentToAttachTo->DoesSocketExist(AttachSocketName) ? AttachSocketName : NAME_None;
-		Gizmo->AttachToComponent(ComponentToAttachTo, FAttachmentTransformRules::SnapToTargetIncludingScale, socketToAttach);
+		//no need to re-attach (and re-snap) if the Gizmo is already where it should be
+		if (Gizmo->GetRootComponent()->GetAttachParent() != ComponentToAttachTo
+			|| Gizmo->GetRootComponent()->GetAttachSocketName() != socketToAttach)
+			Gizmo->AttachToComponent(ComponentToAttachTo, FAttachmentTransformRules::SnapToTargetIncludingScale, socketToAttach);
 	}
 	else
 	{
@@ -993,6 +2796,7 @@ void ATransformerActor::UpdateGizmoPlacement()
 	}
 
 	Gizmo->UpdateGizmoSpace(CurrentSpaceType);
+	MarkViewDirty();
 }
 
 #undef RTT_LOG
@@ -0,0 +1,89 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+
+#include "TransformerTraceQuery.h"
+#include "Engine/World.h"
+
+FTransformerTraceQuery::FTransformerTraceQuery()
+	: bSingleBlockingHit(true)
+	, QueryType(EQueryType::None)
+	, TraceChannel(ECC_Visibility)
+	, QueryParams(SCENE_QUERY_STAT(RuntimeTransformerTrace))
+{
+}
+
+FTransformerTraceQuery FTransformerTraceQuery::ByObjectTypes(const TArray<TEnumAsByte<ECollisionChannel>>& CollisionChannels
+	, const TArray<AActor*>& IgnoredActors, bool bTraceComplex)
+{
+	FTransformerTraceQuery query;
+	query.QueryType = EQueryType::ObjectTypes;
+	query.QueryParams.bTraceComplex = bTraceComplex;
+	query.QueryParams.AddIgnoredActors(IgnoredActors);
+
+	for (const TEnumAsByte<ECollisionChannel>& cc : CollisionChannels)
+		query.ObjectQueryParams.AddObjectTypesToQuery(cc);
+
+	return query;
+}
+
+FTransformerTraceQuery FTransformerTraceQuery::ByChannel(ECollisionChannel TraceChannel
+	, const TArray<AActor*>& IgnoredActors, bool bTraceComplex)
+{
+	FTransformerTraceQuery query;
+	query.QueryType = EQueryType::Channel;
+	query.TraceChannel = TraceChannel;
+	query.QueryParams.bTraceComplex = bTraceComplex;
+	query.QueryParams.AddIgnoredActors(IgnoredActors);
+	return query;
+}
+
+FTransformerTraceQuery FTransformerTraceQuery::ByProfile(FName ProfileName
+	, const TArray<AActor*>& IgnoredActors, bool bTraceComplex)
+{
+	FTransformerTraceQuery query;
+	query.QueryType = EQueryType::Profile;
+	query.ProfileName = ProfileName;
+	query.QueryParams.bTraceComplex = bTraceComplex;
+	query.QueryParams.AddIgnoredActors(IgnoredActors);
+	return query;
+}
+
+bool FTransformerTraceQuery::Trace(const UWorld* World, const FVector& StartLocation, const FVector& EndLocation, bool bSingleHit)
+{
+	//Reset keeps the allocation from previous Traces
+	Hits.Reset();
+	if (!World || !IsValid()) return false;
+
+	if (bSingleHit)
+	{
+		FHitResult& hit = Hits.AddDefaulted_GetRef();
+		bool bHit = false;
+		switch (QueryType)
+		{
+		case EQueryType::ObjectTypes:
+			bHit = World->LineTraceSingleByObjectType(hit, StartLocation, EndLocation, ObjectQueryParams, QueryParams);
+			break;
+		case EQueryType::Channel:
+			bHit = World->LineTraceSingleByChannel(hit, StartLocation, EndLocation, TraceChannel, QueryParams);
+			break;
+		case EQueryType::Profile:
+			bHit = World->LineTraceSingleByProfile(hit, StartLocation, EndLocation, ProfileName, QueryParams);
+			break;
+		}
+		if (!bHit)
+			Hits.Reset();
+		return bHit;
+	}
+
+	switch (QueryType)
+	{
+	case EQueryType::ObjectTypes:
+		return World->LineTraceMultiByObjectType(Hits, StartLocation, EndLocation, ObjectQueryParams, QueryParams);
+	case EQueryType::Channel:
+		return World->LineTraceMultiByChannel(Hits, StartLocation, EndLocation, TraceChannel, QueryParams);
+	case EQueryType::Profile:
+		return World->LineTraceMultiByProfile(Hits, StartLocation, EndLocation, ProfileName, QueryParams);
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,348 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Bounding Volume Hierarchy that is updated incrementally as its entries (proxies) move.
+ *
+ * Every proxy is stored with a "fat" box (its box grown by a margin), so small moves that stay
+ * inside the fat box do not touch the tree at all. Insertion picks the sibling with the smallest
+ * surface area cost, and the tree is kept balanced with AVL rotations, so queries stay O(log N).
+ * Proxy ids are stable until the proxy is destroyed.
+ */
+template<typename UserDataType>
+class TDynamicAABBTree
+{
+	struct FNode
+	{
+		FBox Box;
+		UserDataType UserData;
+		// Parent node, or the next free node while in the free list
+		int32 Parent;
+		int32 Child1;
+		int32 Child2;
+		// 0 for leaves (proxies), INDEX_NONE for free nodes
+		int32 Height;
+
+		bool IsLeaf() const { return Child1 == INDEX_NONE; }
+	};
+
+public:
+
+	TDynamicAABBTree() : Root(INDEX_NONE), FreeList(INDEX_NONE), NumProxies(0) {}
+
+	int32 Num() const { return NumProxies; }
+
+	bool IsValidProxy(int32 ProxyId) const { return Nodes.IsValidIndex(ProxyId) && Nodes[ProxyId].Height == 0; }
+
+	const UserDataType& GetUserData(int32 ProxyId) const { check(IsValidProxy(ProxyId)); return Nodes[ProxyId].UserData; }
+
+	// The fat box of the proxy
+	const FBox& GetFatBox(int32 ProxyId) const { check(IsValidProxy(ProxyId)); return Nodes[ProxyId].Box; }
+
+	// Adds a proxy with the given box, grown by Margin. Returns its id.
+	int32 CreateProxy(const FBox& Box, float Margin, const UserDataType& UserData)
+	{
+		const int32 proxyId = AllocateNode();
+		FNode& node = Nodes[proxyId];
+		node.Box = Box.ExpandBy(Margin);
+		node.UserData = UserData;
+		node.Height = 0;
+		InsertLeaf(proxyId);
+		++NumProxies;
+		return proxyId;
+	}
+
+	void DestroyProxy(int32 ProxyId)
+	{
+		check(IsValidProxy(ProxyId));
+		RemoveLeaf(ProxyId);
+		FreeNode(ProxyId);
+		--NumProxies;
+	}
+
+	/**
+	 * Updates the box of a proxy. The tree is only changed if the box left the fat box of the proxy.
+	 * @return whether the tree was changed
+	 */
+	bool MoveProxy(int32 ProxyId, const FBox& Box, float Margin)
+	{
+		check(IsValidProxy(ProxyId));
+		if (Nodes[ProxyId].Box.IsInsideOrOn(Box.Min) && Nodes[ProxyId].Box.IsInsideOrOn(Box.Max))
+			return false;
+
+		RemoveLeaf(ProxyId);
+		Nodes[ProxyId].Box = Box.ExpandBy(Margin);
+		InsertLeaf(ProxyId);
+		return true;
+	}
+
+	/**
+	 * Calls Visitor(ProxyId) for every proxy whose fat box intersects the given box.
+	 * The Visitor returns false to stop the query. The tree must not be modified during the query.
+	 */
+	template<typename VisitorType>
+	void Query(const FBox& Box, VisitorType&& Visitor) const
+	{
+		if (Root == INDEX_NONE) return;
+
+		TArray<int32, TInlineAllocator<128>> stack;
+		stack.Add(Root);
+		while (stack.Num() > 0)
+		{
+			const int32 nodeIndex = stack.Pop(EAllowShrinking::No);
+			const FNode& node = Nodes[nodeIndex];
+			if (!node.Box.Intersect(Box)) continue;
+
+			if (node.IsLeaf())
+			{
+				if (!Visitor(nodeIndex)) return;
+			}
+			else
+			{
+				stack.Add(node.Child1);
+				stack.Add(node.Child2);
+			}
+		}
+	}
+
+	void Empty()
+	{
+		Nodes.Empty();
+		Root = FreeList = INDEX_NONE;
+		NumProxies = 0;
+	}
+
+private:
+
+	static double GetSurfaceArea(const FBox& Box)
+	{
+		const FVector size = Box.GetSize();
+		return 2.0 * (size.X * size.Y + size.Y * size.Z + size.Z * size.X);
+	}
+
+	int32 AllocateNode()
+	{
+		int32 nodeIndex;
+		if (FreeList != INDEX_NONE)
+		{
+			nodeIndex = FreeList;
+			FreeList = Nodes[nodeIndex].Parent;
+		}
+		else
+			nodeIndex = Nodes.AddDefaulted();
+
+		FNode& node = Nodes[nodeIndex];
+		node.Parent = node.Child1 = node.Child2 = INDEX_NONE;
+		node.Height = 0;
+		return nodeIndex;
+	}
+
+	void FreeNode(int32 NodeIndex)
+	{
+		FNode& node = Nodes[NodeIndex];
+		node.UserData = UserDataType();
+		node.Height = INDEX_NONE;
+		node.Parent = FreeList;
+		FreeList = NodeIndex;
+	}
+
+	void ReplaceChild(int32 Parent, int32 OldChild, int32 NewChild)
+	{
+		if (Parent == INDEX_NONE)
+			Root = NewChild;
+		else if (Nodes[Parent].Child1 == OldChild)
+			Nodes[Parent].Child1 = NewChild;
+		else
+			Nodes[Parent].Child2 = NewChild;
+	}
+
+	// Recomputes the Box and Height of every node from the given one to the root, balancing them on the way
+	void RefitAncestors(int32 NodeIndex)
+	{
+		while (NodeIndex != INDEX_NONE)
+		{
+			NodeIndex = Balance(NodeIndex);
+
+			FNode& node = Nodes[NodeIndex];
+			const FNode& child1 = Nodes[node.Child1];
+			const FNode& child2 = Nodes[node.Child2];
+			node.Height = 1 + FMath::Max(child1.Height, child2.Height);
+			node.Box = child1.Box + child2.Box;
+
+			NodeIndex = node.Parent;
+		}
+	}
+
+	void InsertLeaf(int32 Leaf)
+	{
+		if (Root == INDEX_NONE)
+		{
+			Root = Leaf;
+			Nodes[Leaf].Parent = INDEX_NONE;
+			return;
+		}
+
+		//Find the best sibling: descend while going down is cheaper than pairing with the current node
+		const FBox leafBox = Nodes[Leaf].Box;
+		int32 index = Root;
+		while (!Nodes[index].IsLeaf())
+		{
+			const FNode& node = Nodes[index];
+			const double area = GetSurfaceArea(node.Box);
+			const double combinedArea = GetSurfaceArea(node.Box + leafBox);
+
+			//cost of creating a new parent for this node and the leaf
+			const double cost = 2.0 * combinedArea;
+			//minimum cost of pushing the leaf further down the tree
+			const double inheritanceCost = 2.0 * (combinedArea - area);
+
+			auto descendCost = [&](int32 Child)
+				{
+					const FNode& childNode = Nodes[Child];
+					const double childCombinedArea = GetSurfaceArea(childNode.Box + leafBox);
+					return (childNode.IsLeaf() ? childCombinedArea : childCombinedArea - GetSurfaceArea(childNode.Box))
+						+ inheritanceCost;
+				};
+
+			const double cost1 = descendCost(node.Child1);
+			const double cost2 = descendCost(node.Child2);
+
+			if (cost < cost1 && cost < cost2) break;
+			index = cost1 < cost2 ? node.Child1 : node.Child2;
+		}
+
+		const int32 sibling = index;
+		const int32 oldParent = Nodes[sibling].Parent;
+		const int32 newParent = AllocateNode(); //can relocate Nodes
+
+		FNode& parentNode = Nodes[newParent];
+		parentNode.Parent = oldParent;
+		parentNode.Box = leafBox + Nodes[sibling].Box;
+		parentNode.Height = Nodes[sibling].Height + 1;
+		parentNode.Child1 = sibling;
+		parentNode.Child2 = Leaf;
+
+		Nodes[sibling].Parent = newParent;
+		Nodes[Leaf].Parent = newParent;
+		ReplaceChild(oldParent, sibling, newParent);
+
+		RefitAncestors(newParent);
+	}
+
+	void RemoveLeaf(int32 Leaf)
+	{
+		if (Leaf == Root)
+		{
+			Root = INDEX_NONE;
+			return;
+		}
+
+		const int32 parent = Nodes[Leaf].Parent;
+		const int32 grandParent = Nodes[parent].Parent;
+		const int32 sibling = Nodes[parent].Child1 == Leaf ? Nodes[parent].Child2 : Nodes[parent].Child1;
+
+		//the sibling takes the place of the parent
+		ReplaceChild(grandParent, parent, sibling);
+		Nodes[sibling].Parent = grandParent;
+		FreeNode(parent);
+
+		RefitAncestors(grandParent);
+	}
+
+	// Rotates the given node with one of its children if their heights differ by more than 1. Returns the node now in its place.
+	int32 Balance(int32 IndexA)
+	{
+		FNode& a = Nodes[IndexA];
+		if (a.IsLeaf() || a.Height < 2)
+			return IndexA;
+
+		const int32 indexB = a.Child1;
+		const int32 indexC = a.Child2;
+		FNode& b = Nodes[indexB];
+		FNode& c = Nodes[indexC];
+
+		const int32 balance = c.Height - b.Height;
+
+		//Rotate C up
+		if (balance > 1)
+		{
+			const int32 indexF = c.Child1;
+			const int32 indexG = c.Child2;
+			FNode& f = Nodes[indexF];
+			FNode& g = Nodes[indexG];
+
+			c.Child1 = IndexA;
+			c.Parent = a.Parent;
+			a.Parent = indexC;
+			ReplaceChild(c.Parent, IndexA, indexC);
+
+			if (f.Height > g.Height)
+			{
+				c.Child2 = indexF;
+				a.Child2 = indexG;
+				g.Parent = IndexA;
+				a.Box = b.Box + g.Box;
+				c.Box = a.Box + f.Box;
+				a.Height = 1 + FMath::Max(b.Height, g.Height);
+				c.Height = 1 + FMath::Max(a.Height, f.Height);
+			}
+			else
+			{
+				c.Child2 = indexG;
+				a.Child2 = indexF;
+				f.Parent = IndexA;
+				a.Box = b.Box + f.Box;
+				c.Box = a.Box + g.Box;
+				a.Height = 1 + FMath::Max(b.Height, f.Height);
+				c.Height = 1 + FMath::Max(a.Height, g.Height);
+			}
+			return indexC;
+		}
+
+		//Rotate B up
+		if (balance < -1)
+		{
+			const int32 indexD = b.Child1;
+			const int32 indexE = b.Child2;
+			FNode& d = Nodes[indexD];
+			FNode& e = Nodes[indexE];
+
+			b.Child1 = IndexA;
+			b.Parent = a.Parent;
+			a.Parent = indexB;
+			ReplaceChild(b.Parent, IndexA, indexB);
+
+			if (d.Height > e.Height)
+			{
+				b.Child2 = indexD;
+				a.Child1 = indexE;
+				e.Parent = IndexA;
+				a.Box = c.Box + e.Box;
+				b.Box = a.Box + d.Box;
+				a.Height = 1 + FMath::Max(c.Height, e.Height);
+				b.Height = 1 + FMath::Max(a.Height, d.Height);
+			}
+			else
+			{
+				b.Child2 = indexE;
+				a.Child1 = indexD;
+				d.Parent = IndexA;
+				a.Box = c.Box + d.Box;
+				b.Box = a.Box + e.Box;
+				a.Height = 1 + FMath::Max(c.Height, d.Height);
+				b.Height = 1 + FMath::Max(a.Height, e.Height);
+			}
+			return indexB;
+		}
+
+		return IndexA;
+	}
+
+	TArray<FNode> Nodes;
+	int32 Root;
+	int32 FreeList;
+	int32 NumProxies;
+};
@@ -34,5 +34,15 @@ public:
 	//Called when there is a Delta Transform in World Space (Local for Scaling) that has been calculated for the Selected Focusable Object.
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Focusable")
 	void OnNewTransformation(class ATransformerActor* Caller, class USceneComponent* Component, const FTransform& NewTransform, bool bComponentBased);
+	virtual void OnNewTransformation_Implementation(class ATransformerActor* Caller, class USceneComponent* Component, const FTransform& NewTransform, bool bComponentBased);
+
+	/**
+	 * Called once per frame with the new Transforms of all the Selected Components of this Focusable Object,
+	 * instead of OnNewTransformation, if the Transformer has bBatchFocusableNotifications.
+	 * By default it calls OnNewTransformation for each Component.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Focusable")
+	void OnNewTransformations(class ATransformerActor* Caller, const TArray<class USceneComponent*>& Components, const TArray<FTransform>& NewTransforms, bool bComponentBased);
+	virtual void OnNewTransformations_Implementation(class ATransformerActor* Caller, const TArray<class USceneComponent*>& Components, const TArray<FTransform>& NewTransforms, bool bComponentBased);
 
 };
@@ -0,0 +1,71 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GizmoPoolSubsystem.generated.h"
+
+/**
+ * Pool of Gizmo Actors shared by every Transformer in a World.
+ *
+ * Gizmos are spawned once (Prewarm) and leased to a Transformer while it has a Selection.
+ * Released Gizmos are hidden and kept for the next Transformer that needs one of the same class,
+ * so a World with many Transformers only spawns as many Gizmos as are visible at the same time.
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UGizmoPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * Makes sure there are at least the given number of free Gizmos of the given class,
+	 * so that leasing them later does not have to spawn any Actor.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	void Prewarm(TSubclassOf<class ABaseGizmo> GizmoClass, int32 Count = 1);
+
+	/**
+	 * Gets a Gizmo of the given class (shown, ticking and with collision enabled).
+	 * It is spawned if there is no free Gizmo of that class. Must be given back with ReleaseGizmo.
+	 * @return the leased Gizmo, or nullptr if it could not be spawned
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	class ABaseGizmo* LeaseGizmo(TSubclassOf<class ABaseGizmo> GizmoClass);
+
+	/**
+	 * Gives back a Gizmo got from LeaseGizmo. It is detached, hidden and kept for the next lease.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	void ReleaseGizmo(class ABaseGizmo* Gizmo);
+
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	int32 GetNumFreeGizmos() const { return FreeGizmos.Num(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	int32 GetNumLeasedGizmos() const { return LeasedGizmos.Num(); }
+
+protected:
+
+	//Gizmos are only needed where there is gameplay
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	class ABaseGizmo* SpawnGizmo(UClass* GizmoClass);
+
+	//Removes the Gizmos that were destroyed by something else than this Subsystem
+	void RemoveInvalidGizmos();
+
+	// Hidden Gizmos that are ready to be leased
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<class ABaseGizmo>> FreeGizmos;
+
+	// Gizmos currently used by a Transformer
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<class ABaseGizmo>> LeasedGizmos;
+};
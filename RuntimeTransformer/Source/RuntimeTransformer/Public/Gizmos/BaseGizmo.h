@@ -31,6 +31,8 @@ public:
 	 * Scales the Gizmo Scene depending on a Reference Point
 	 * The scale depends on the Gizmo Screen Space Radius specified,
 	 * and the Gizmo Scene Scale Factor.
+	 * The Scale is only applied if it changed by more than the Scene Scale Tolerance,
+	 * since every change has to be propagated to all the Components (and Physics Bodies) under the Scaling Scene.
 	 * @param Reference Location - The Location of where the Gizmo is seen (i.e. Camera Location)
 	 * @param Reference Look Direction - the direction the reference is looking (i.e. Camera Look Direction)
 	 * @param FieldOfView - Field of View of Camera, in Degrees
@@ -40,6 +42,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Gizmo")
 	ETransformationDomain GetTransformationDomain(class USceneComponent* ComponentHit) const;
 
+	/**
+	 * Tests the Ray against the Domain Components without going through the Physics Scene.
+	 * Box, Sphere and Capsule Components registered with RegisterDomainComponent are tested with their shape
+	 * (in their Component Space, so Scale is taken into account), and Rings registered with RegisterDomainRing
+	 * are tested as flat annuli. Can be called every frame (e.g. for hover highlighting).
+	 * @param OutHitDistance - distance from the Ray Start to the closest hit (only valid if a Domain is returned)
+	 * @return the Domain of the closest hit, or None if the Ray misses the Gizmo
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	virtual ETransformationDomain TraceTransformationDomain(const FVector& RayStartPoint, const FVector& RayEndPoint
+		, float& OutHitDistance) const;
+
 	// Returns a Snapped Transform based on how much has been accumulated, the Delta Transform and Snapping Value
 	// Also changes the Accumulated Transform based on how much was snapped
 	virtual FTransform GetSnappedTransform(FTransform& outCurrentAccumulatedTransform
@@ -75,6 +89,15 @@ protected:
 	void RegisterDomainComponent(class USceneComponent* Component
 		, ETransformationDomain Domain);
 
+	/**
+	 * Adds a Ring (flat annulus on the XY Plane of the Component) for TraceTransformationDomain.
+	 * Useful for Rotation Gizmos, whose Domains are rings that can't be described with Box Components.
+	 * @param InnerRadius / OuterRadius - in Component Space
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Gizmo")
+	void RegisterDomainRing(class USceneComponent* Component
+		, ETransformationDomain Domain, float InnerRadius, float OuterRadius);
+
 public:
 
 	UFUNCTION(BlueprintCallable, Category = "Gizmo")
@@ -126,13 +149,37 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gizmo")
 	float CameraArcRadius;
 
+	/* How much (relative to the current Scale) the Gizmo Scene Scale must change before it is re-applied.
+	 * 0 re-applies it on every change. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gizmo", meta = (ClampMin = "0.0"))
+	float SceneScaleTolerance;
+
 private:
+
+	// A Ring registered by RegisterDomainRing
+	struct FDomainRing
+	{
+		TWeakObjectPtr<class USceneComponent> Component;
+		ETransformationDomain Domain;
+		float InnerRadius;
+		float OuterRadius;
+	};
+
+	TArray<FDomainRing> DomainRings;
+
+	// Number of Scene Components that a Transform change to the Gizmo has to update (for stats only)
+	int32 GetNumComponentsToUpdate(bool bScalingSceneOnly);
+
 	// Maps the Box Component to their Respective Domain
 	TMap<class UShapeComponent*, ETransformationDomain> DomainMap;
 
 	//Whether Transform is in Progress or Not
 	bool bTransformInProgress;
 
+	// Cached Component counts for GetNumComponentsToUpdate (INDEX_NONE if not computed yet)
+	int32 NumActorSceneComponents;
+	int32 NumScalingSceneComponents;
+
 protected:
 
 	//bool to check whether the PrevRay vectors have been set
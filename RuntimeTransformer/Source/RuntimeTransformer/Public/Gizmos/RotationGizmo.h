@@ -18,6 +18,8 @@ public:
 
 	ARotationGizmo();
 
+	virtual void OnConstruction(const FTransform& Transform) override;
+
 	virtual ETransformationType GetGizmoType() const final { return ETransformationType::TT_Rotation; }
 
 	// Returns a Snapped Transform based on how much has been accumulated, the Delta Transform and Snapping Value
@@ -37,6 +39,23 @@ protected:
 		, const FVector& RayEndPoint
 		,  ETransformationDomain Domain) override;
 
+	// The Rings (on their XY Plane) picked by TraceTransformationDomain for the Rotation around each Axis
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Gizmo")
+	class USceneComponent* X_AxisRing;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Gizmo")
+	class USceneComponent* Y_AxisRing;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Gizmo")
+	class USceneComponent* Z_AxisRing;
+
+	/* Radii of the Rings, in Component Space (under the Scaling Scene). Should match the Gizmo's Rotation Meshes. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gizmo", meta = (ClampMin = "0.0"))
+	float RingInnerRadius;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gizmo", meta = (ClampMin = "0.0"))
+	float RingOuterRadius;
+
 private:
 
 	FVector PreviousRotationViewScale;
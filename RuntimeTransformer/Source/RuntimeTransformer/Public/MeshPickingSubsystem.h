@@ -0,0 +1,84 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "MeshPickingSubsystem.generated.h"
+
+class FMeshTriangleBVH;
+
+enum class EMeshPickResult : uint8
+{
+	// The Mesh has no CPU accessible Triangles, so the Hit could not be refined
+	NoMeshData,
+	Miss,
+	Hit,
+};
+
+/**
+ * Cache of the Triangle BVHs (FMeshTriangleBVH) of the Static Meshes picked in a World.
+ *
+ * A BVH is built the first time a Mesh is picked, from the Positions and Indices of its first LOD,
+ * and shared by every Component (and Instance) using that Mesh. Needs "Allow CPU Access" on the
+ * Mesh in cooked builds (the Editor always keeps the CPU copy of the Render Data).
+ */
+UCLASS()
+class RUNTIMETRANSFORMER_API UMeshPickingSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Deinitialize() override;
+
+	/**
+	 * Refines a Hit on a Static Mesh Component (e.g. on its Simple Collision) to the closest Triangle hit by the Hit's Trace.
+	 * If a Triangle is hit, the Location, Normal, Distance, Time and FaceIndex of the Hit are set to it.
+	 * Instanced Static Mesh Hits are tested against the hit Instance (the Item of the Hit).
+	 */
+	EMeshPickResult RefineHit(FHitResult& InOutHit);
+
+	// Gets the BVH of the given Mesh, building it if it was not built yet. Null if the Mesh has no CPU accessible Triangles
+	TSharedPtr<const FMeshTriangleBVH> FindOrBuildBVH(const class UStaticMesh* Mesh);
+
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	int32 GetNumCachedMeshes() const { return CachedMeshes.Num(); }
+
+	// Memory (in bytes) used by every cached BVH
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	int64 GetCachedMemory() const { return CachedMemory; }
+
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void EmptyCache();
+
+protected:
+
+	//Picking is only needed where there is gameplay
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+
+	struct FCachedMesh
+	{
+		// Null if the Mesh had no CPU accessible Triangles
+		TSharedPtr<const FMeshTriangleBVH> BVH;
+
+		// Render Data the BVH was built from (rebuilt if the Mesh gets new Render Data)
+		const void* RenderData = nullptr;
+
+		// Whether a null BVH is only because the Triangles are not there yet (e.g. not streamed in), so it is built again on the next pick
+		bool bRetry = false;
+	};
+
+	/**
+	 * @param bOutRetry - set if no BVH could be built for now but might be later (as opposed to never, e.g. no CPU Access)
+	 */
+	TSharedPtr<const FMeshTriangleBVH> BuildBVH(const class UStaticMesh* Mesh, bool& bOutRetry) const;
+
+	// Object Keys, so a destroyed Mesh is never confused with a new one
+	TMap<TObjectKey<class UStaticMesh>, FCachedMesh> CachedMeshes;
+
+	int64 CachedMemory = 0;
+};
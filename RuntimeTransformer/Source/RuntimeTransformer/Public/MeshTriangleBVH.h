@@ -0,0 +1,69 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Closest Triangle hit by a Ray tested against a FMeshTriangleBVH
+struct FMeshTriangleHit
+{
+	// Where along the Ray (0 at its Start, 1 at its End) the Triangle was hit
+	float Time = 1.f;
+
+	// Index of the Triangle in the Index Buffer the BVH was built from
+	int32 TriangleIndex = INDEX_NONE;
+
+	// Vertices of the Triangle (in the space of the BVH)
+	FVector3f A, B, C;
+};
+
+/**
+ * Bounding Volume Hierarchy of the Triangles of a Mesh, used for Triangle-accurate picking without Complex Collision.
+ *
+ * Built once from a copy of the Mesh Positions and Indices (the Triangles are reordered so every leaf is contiguous)
+ * and never modified, so it can be shared by every Component that uses the Mesh.
+ */
+class RUNTIMETRANSFORMER_API FMeshTriangleBVH
+{
+public:
+
+	FMeshTriangleBVH(TArray<FVector3f>&& InVertices, const TArray<uint32>& InIndices);
+
+	int32 GetNumTriangles() const { return TriangleIds.Num(); }
+
+	// Memory used by this BVH
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * Finds the closest Triangle (either side) hit by the Ray going from Start to Start + Direction.
+	 * @return whether a Triangle was hit
+	 */
+	bool Raycast(const FVector3f& Start, const FVector3f& Direction, FMeshTriangleHit& OutHit) const;
+
+private:
+
+	struct FNode
+	{
+		FVector3f Min;
+		// Inner Nodes: index of the second child (the first one is right after this Node). Leaves: first Triangle
+		int32 ChildOrFirstTriangle;
+		FVector3f Max;
+		// 0 for Inner Nodes
+		int32 NumTriangles;
+	};
+
+	// Builds the Node for the Triangles in [First, First + Count), reordering them. Returns the Node index
+	int32 BuildNode(TArray<FVector3f>& Centroids, int32 First, int32 Count);
+
+	bool RaycastTriangle(int32 Triangle, const FVector3f& Start, const FVector3f& Direction, float& InOutTime) const;
+
+	TArray<FVector3f> Vertices;
+
+	// 3 Vertex Indices per Triangle, in leaf order
+	TArray<uint32> Indices;
+
+	// Original index of every Triangle (in leaf order)
+	TArray<int32> TriangleIds;
+
+	TArray<FNode> Nodes;
+};
@@ -0,0 +1,122 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Set that remembers the order in which its elements were added.
+ *
+ * Elements live in a sparse array of nodes linked in insertion order, and a map from
+ * element to node index gives O(1) Contains/Add/Remove. First/Last are O(1) since the
+ * head and tail of the list are tracked. Removing an element never changes the relative order
+ * of the remaining ones, which is what Gizmo Placement (first/last selection) relies on.
+ */
+template<typename ElementType>
+class TOrderedSelectionSet
+{
+	struct FNode
+	{
+		ElementType Element;
+		int32 Prev;
+		int32 Next;
+	};
+
+public:
+
+	class TConstIterator
+	{
+	public:
+		TConstIterator(const TOrderedSelectionSet& InSet, int32 InNodeIndex)
+			: Set(InSet), NodeIndex(InNodeIndex) {}
+
+		TConstIterator& operator++() { NodeIndex = Set.Nodes[NodeIndex].Next; return *this; }
+		const ElementType& operator*() const { return Set.Nodes[NodeIndex].Element; }
+		explicit operator bool() const { return NodeIndex != INDEX_NONE; }
+		bool operator!=(const TConstIterator& Other) const { return NodeIndex != Other.NodeIndex; }
+
+	private:
+		const TOrderedSelectionSet& Set;
+		int32 NodeIndex;
+	};
+
+	TOrderedSelectionSet() : Head(INDEX_NONE), Tail(INDEX_NONE) {}
+
+	int32 Num() const { return IndexMap.Num(); }
+	bool IsEmpty() const { return Head == INDEX_NONE; }
+
+	bool Contains(const ElementType& Element) const { return IndexMap.Contains(Element); }
+
+	// Adds the Element at the end of the order. Returns false if it was already in the set.
+	bool Add(const ElementType& Element)
+	{
+		if (IndexMap.Contains(Element)) return false;
+
+		const int32 NodeIndex = Nodes.Add(FNode{ Element, Tail, INDEX_NONE });
+		if (Tail != INDEX_NONE)
+			Nodes[Tail].Next = NodeIndex;
+		else
+			Head = NodeIndex;
+		Tail = NodeIndex;
+
+		IndexMap.Add(Element, NodeIndex);
+		return true;
+	}
+
+	// Removes the Element keeping the order of the rest. Returns false if it was not in the set.
+	bool Remove(const ElementType& Element)
+	{
+		int32 NodeIndex;
+		if (!IndexMap.RemoveAndCopyValue(Element, NodeIndex)) return false;
+
+		const FNode& Node = Nodes[NodeIndex];
+		if (Node.Prev != INDEX_NONE) Nodes[Node.Prev].Next = Node.Next;
+		else Head = Node.Next;
+
+		if (Node.Next != INDEX_NONE) Nodes[Node.Next].Prev = Node.Prev;
+		else Tail = Node.Prev;
+
+		Nodes.RemoveAt(NodeIndex);
+		return true;
+	}
+
+	// First / Last Element added that is still in the set. Must not be called on an empty set.
+	const ElementType& First() const { check(Head != INDEX_NONE); return Nodes[Head].Element; }
+	const ElementType& Last() const { check(Tail != INDEX_NONE); return Nodes[Tail].Element; }
+
+	void Reserve(int32 Number)
+	{
+		Nodes.Reserve(Number);
+		IndexMap.Reserve(Number);
+	}
+
+	void Empty(int32 Slack = 0)
+	{
+		Nodes.Empty(Slack);
+		IndexMap.Empty(Slack);
+		Head = Tail = INDEX_NONE;
+	}
+
+	// Copies the Elements into an Array, in the order they were added
+	TArray<ElementType> Array() const
+	{
+		TArray<ElementType> Result;
+		Result.Reserve(Num());
+		for (const ElementType& Element : *this)
+			Result.Add(Element);
+		return Result;
+	}
+
+	TConstIterator CreateConstIterator() const { return TConstIterator(*this, Head); }
+
+	// ranged-for support. The set must not be modified while iterating.
+	TConstIterator begin() const { return TConstIterator(*this, Head); }
+	TConstIterator end() const { return TConstIterator(*this, INDEX_NONE); }
+
+private:
+
+	TSparseArray<FNode> Nodes;
+	TMap<ElementType, int32> IndexMap;
+	int32 Head;
+	int32 Tail;
+};
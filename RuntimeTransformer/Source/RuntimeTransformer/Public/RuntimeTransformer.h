@@ -8,6 +8,8 @@
 
 DECLARE_LOG_CATEGORY_EXTERN(LogRuntimeTransformer, Log, All);
 
+DECLARE_STATS_GROUP(TEXT("RuntimeTransformer"), STATGROUP_RuntimeTransformer, STATCAT_Advanced);
+
 UENUM(BlueprintType)
 enum class ETransformationType : uint8
 {
@@ -0,0 +1,55 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Bounds of the Marquee / Lasso Selection candidates stored as Structure of Arrays.
+ *
+ * Project computes the Screen Rect of every candidate (the rect around its 8 projected Bounds corners)
+ * 4 candidates at a time (VectorRegister4Double), and the GetIn* functions test those rects against a Screen Region.
+ * Nothing here needs a Viewport or the GPU: only a View Projection Matrix and a View Rect.
+ */
+struct RUNTIMETRANSFORMER_API FScreenSelectionBuffer
+{
+	TArray<class UPrimitiveComponent*> Components;
+
+	TArray<double> CenterX;
+	TArray<double> CenterY;
+	TArray<double> CenterZ;
+
+	TArray<double> ExtentX;
+	TArray<double> ExtentY;
+	TArray<double> ExtentZ;
+
+	// Screen Rect in pixels, filled by Project. Min > Max if the candidate is not in front of the camera
+	TArray<double> ScreenMinX;
+	TArray<double> ScreenMinY;
+	TArray<double> ScreenMaxX;
+	TArray<double> ScreenMaxY;
+
+	int32 Num() const { return Components.Num(); }
+
+	void Reserve(int32 Number);
+
+	// Clears all the entries (keeping the allocations for the next selection)
+	void Reset();
+
+	int32 Add(class UPrimitiveComponent* Component, const FBoxSphereBounds& Bounds);
+
+	/**
+	 * Projects every candidate. Bounds that cross the camera plane are reduced to their projected Center
+	 * (or left off screen if the Center is behind the camera).
+	 * @param ViewProjection - World to Clip Space Matrix
+	 * @param ViewRect - the pixels of the Viewport the Clip Space maps to
+	 * @param bParallel - whether to split the candidates in batches processed with ParallelFor
+	 */
+	void Project(const FMatrix& ViewProjection, const FIntRect& ViewRect, bool bParallel = false);
+
+	// Indices of the candidates whose Screen Rect intersects (or is fully inside) the given Rect
+	void GetInRect(const FBox2D& Rect, bool bRequireFullyInside, TArray<int32>& OutIndices) const;
+
+	// Indices of the candidates whose Screen Rect Center is inside the given Polygon (even-odd rule)
+	void GetInPolygon(TConstArrayView<FVector2D> Polygon, TArray<int32>& OutIndices) const;
+};
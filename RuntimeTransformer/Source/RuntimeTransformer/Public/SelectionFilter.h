@@ -0,0 +1,116 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SubclassOf.h"
+#include "UObject/ObjectKey.h"
+#include "SelectionFilter.generated.h"
+
+class AActor;
+class USceneComponent;
+
+// What a Selection Filter rule decided about a candidate
+enum class ESelectionFilterResult : uint8
+{
+	// The rule does not care about this candidate, the next rules decide
+	Undecided,
+	// Selectable, without asking the remaining rules (nor ShouldSelect)
+	Select,
+	// Not Selectable
+	Reject,
+	// Selectable only if ShouldSelect (the Blueprint Event) says so
+	AskShouldSelect,
+};
+
+/**
+ * Class and Tag rules of a Selection Filter, editable in the Transformer.
+ * Empty lists do not filter anything. Denied entries win over Allowed ones.
+ */
+USTRUCT(BlueprintType)
+struct RUNTIMETRANSFORMER_API FSelectionFilterRules
+{
+	GENERATED_BODY()
+
+	// If not empty, only Components owned by Actors of these classes (or their children) are Selectable
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Selection Filter")
+	TArray<TSubclassOf<AActor>> AllowedActorClasses;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Selection Filter")
+	TArray<TSubclassOf<AActor>> DeniedActorClasses;
+
+	// If not empty, only Components of these classes (or their children) are Selectable
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Selection Filter")
+	TArray<TSubclassOf<USceneComponent>> AllowedComponentClasses;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Selection Filter")
+	TArray<TSubclassOf<USceneComponent>> DeniedComponentClasses;
+
+	// If not empty, only candidates whose Owner Actor or Component has one of these Tags are Selectable
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Selection Filter")
+	TArray<FName> AllowedTags;
+
+	// Candidates whose Owner Actor or Component has one of these Tags are not Selectable
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Selection Filter")
+	TArray<FName> DeniedTags;
+};
+
+/**
+ * Native pipeline deciding whether a candidate (Owner Actor and Component) is Selectable, before (or instead of) ShouldSelect.
+ *
+ * Rules run in this order, and the first one that decides (not Undecided) wins:
+ * the Class Lists and Class Rules (cached per Actor Class / Component Class pair), the Tag Lists, and the Instance Rules.
+ * The cache is emptied whenever a rule is changed.
+ */
+class RUNTIMETRANSFORMER_API FSelectionFilter
+{
+public:
+
+	// Rule that only depends on the classes of the candidate, so its result is cached per class pair
+	typedef TFunction<ESelectionFilterResult(const UClass* /*ActorClass*/, const UClass* /*ComponentClass*/)> FClassRule;
+
+	// Rule that depends on the candidate itself (evaluated every time)
+	typedef TFunction<ESelectionFilterResult(AActor* /*OwnerActor*/, USceneComponent* /*Component*/)> FInstanceRule;
+
+	FSelectionFilter() : NextRuleId(0) {}
+
+	void SetRules(const FSelectionFilterRules& InRules);
+	const FSelectionFilterRules& GetRules() const { return Rules; }
+
+	// Registers a native rule. @return the id to remove it with RemoveRule
+	int32 AddClassRule(FClassRule Rule);
+	int32 AddInstanceRule(FInstanceRule Rule);
+
+	// @return whether a rule with that id was registered
+	bool RemoveRule(int32 RuleId);
+
+	// Whether there is nothing to evaluate (every candidate is Undecided)
+	bool IsEmpty() const;
+
+	/**
+	 * Evaluates every rule on the candidate.
+	 * @return Undecided if no rule decided (the caller applies its default)
+	 */
+	ESelectionFilterResult Evaluate(AActor* OwnerActor, USceneComponent* Component) const;
+
+	// Evaluates every candidate of the given arrays (same length, Owners may be null). OutResults is filled with a result per candidate
+	void Evaluate(TConstArrayView<AActor*> OwnerActors, TConstArrayView<USceneComponent*> Components, TArray<ESelectionFilterResult>& OutResults) const;
+
+	int32 GetNumCachedClasses() const { return ClassCache.Num(); }
+
+private:
+
+	ESelectionFilterResult EvaluateClasses(const UClass* ActorClass, const UClass* ComponentClass) const;
+	ESelectionFilterResult EvaluateTags(const AActor* OwnerActor, const USceneComponent* Component) const;
+
+	void InvalidateCache() { ClassCache.Reset(); }
+
+	FSelectionFilterRules Rules;
+
+	TArray<TPair<int32, FClassRule>> ClassRules;
+	TArray<TPair<int32, FInstanceRule>> InstanceRules;
+	int32 NextRuleId;
+
+	// Result of the Class Lists and Class Rules per Actor Class / Component Class pair
+	mutable TMap<TPair<TObjectKey<UClass>, TObjectKey<UClass>>, ESelectionFilterResult> ClassCache;
+};
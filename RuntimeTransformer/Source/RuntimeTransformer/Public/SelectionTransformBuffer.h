@@ -0,0 +1,114 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Entries of a FSelectionTransformBuffer whose Components are attached to the same Parent (and Socket)
+ */
+struct FSelectionAttachGroup
+{
+	class USceneComponent* Parent;
+
+	// Same as Parent, to find out whether it was destroyed without reading it (see RemoveDestroyedComponents)
+	TWeakObjectPtr<class USceneComponent> ParentHandle;
+
+	FName SocketName;
+	TArray<int32> Indices;
+};
+
+/**
+ * World to Relative Transform conversion for the Components of a FSelectionAttachGroup,
+ * so the Parent (Socket) Transform is only read and inverted once per group
+ */
+struct RUNTIMETRANSFORMER_API FSelectionAttachSpace
+{
+	explicit FSelectionAttachSpace(const FSelectionAttachGroup& Group);
+
+	// Whether the Attach Parent was destroyed (its Components can't be committed)
+	bool bParentInvalid;
+
+	// Whether the Parent has a negative (mirrored) or zero scale, which needs the full FTransform::GetRelativeTransform handling
+	bool bMirrored;
+
+	FQuat InverseRotation;
+	FVector InverseScale;
+	FVector ParentLocation;
+
+	// Only valid if !bMirrored
+	FTransform GetRelativeTransform(const FTransform& WorldTransform) const;
+};
+
+/**
+ * World Transforms of the Selected Components stored as Structure of Arrays.
+ *
+ * Gathered once when a Transform begins and kept up to date by the Transformer as it applies
+ * every Delta Transform, so a drag does not need to read the Component Transforms every frame.
+ * Keeping each scalar in its own array lets ApplyDelta work on 4 Components at once (VectorRegister4Double).
+ */
+struct RUNTIMETRANSFORMER_API FSelectionTransformBuffer
+{
+	TArray<class USceneComponent*> Components;
+
+	// Same entries as Components, to find out which were destroyed without reading them (see RemoveDestroyedComponents)
+	TArray<TWeakObjectPtr<class USceneComponent>> ComponentHandles;
+
+	TArray<double> LocationX;
+	TArray<double> LocationY;
+	TArray<double> LocationZ;
+
+	TArray<double> RotationX;
+	TArray<double> RotationY;
+	TArray<double> RotationZ;
+	TArray<double> RotationW;
+
+	TArray<double> ScaleX;
+	TArray<double> ScaleY;
+	TArray<double> ScaleZ;
+
+	// Entries grouped by Attach Parent, so the Parent Transform is only computed once per group when committing
+	TArray<FSelectionAttachGroup> AttachGroups;
+
+	// Entries that can't be grouped by Parent since they use Absolute Location, Rotation or Scale
+	TArray<int32> WorldSpaceIndices;
+
+	int32 Num() const { return Components.Num(); }
+
+	void Reserve(int32 Number);
+
+	// Clears all the entries (keeping the allocations for the next gather)
+	void Reset();
+
+	int32 Add(class USceneComponent* Component, const FTransform& Transform);
+
+	// Fills AttachGroups / WorldSpaceIndices with the current Attach Parents of the Components
+	void BuildAttachGroups();
+
+	/**
+	 * Nulls the Components that were destroyed, and the ones attached to a destroyed Parent (they can't be committed
+	 * relative to it). The entries are kept, so their indices stay valid.
+	 * Must be called after every Garbage Collection while the buffer is kept, since the raw pointers are not GC references.
+	 */
+	void RemoveDestroyedComponents();
+
+	FTransform GetTransform(int32 Index) const;
+	void SetTransform(int32 Index, const FTransform& Transform);
+
+	// Copies the Transforms of a buffer with the same entries (e.g. a snapshot of this one)
+	void CopyTransformsFrom(const FSelectionTransformBuffer& Other);
+
+	// Whether ApplyDelta would not change anything with the given Delta Transform
+	static bool IsIdentityDelta(const FTransform& DeltaTransform);
+
+	/**
+	 * Applies the Delta Transform to every entry, the same way as ATransformerActor::ApplyDeltaTransform:
+	 * Rotation is prepended, Scale is added in Local Space and Location is rotated around the Pivot
+	 * (unless bRotateOnLocalAxis) and then offset.
+	 * The kernel is chosen at compile time by which parts of the Delta are not identity,
+	 * so e.g. a Translation drag is a pure vector add.
+	 * @param bParallel - whether to split the entries in batches processed with ParallelFor
+	 * @return false if the Delta is identity (nothing was changed)
+	 */
+	bool ApplyDelta(const FTransform& DeltaTransform, const FVector& Pivot, bool bRotateOnLocalAxis, bool bParallel = false);
+};
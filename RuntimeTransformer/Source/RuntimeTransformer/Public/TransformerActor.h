@@ -4,7 +4,15 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
+#include "WorldCollision.h"
 #include "RuntimeTransformer.h"
+#include "OrderedSelectionSet.h"
+#include "SelectionTransformBuffer.h"
+#include "TransformerTraceQuery.h"
+#include "DynamicAABBTree.h"
+#include "ScreenSelectionBuffer.h"
+#include "SelectionFilter.h"
+#include "UObject/ObjectKey.h"
 #include "TransformerActor.generated.h"
 
 UENUM(BlueprintType)
@@ -15,6 +23,76 @@ enum class EGizmoPlacement : uint8
 	GP_OnLastSelection		UMETA(DisplayName = "On Last Selection"),
 };
 
+/**
+ * Weak handle to a Selected Component: its Object Index and Serial Number (8 bytes).
+ * It never dangles (it resolves to null once the Component is destroyed), and it is not a strong reference,
+ * so the Selection does not keep destroyed or streamed out Components alive.
+ */
+typedef TWeakObjectPtr<class USceneComponent> FSelectionHandle;
+
+// UFocusable Object of a Selected Component, resolved once when the Component is Selected
+struct FCachedFocusable
+{
+	TWeakObjectPtr<UObject> Object;
+
+	// Set if Object implements OnNewTransformation natively (not in Blueprint), so it can be called without the Blueprint thunk
+	class IFocusableObject* NativeInterface = nullptr;
+
+	// Same for OnNewTransformations
+	class IFocusableObject* NativeBatchInterface = nullptr;
+};
+
+// Original Mobility of a Component whose Mobility was forced to Movable (see bForceMobility)
+struct FForcedMobility
+{
+	TWeakObjectPtr<class USceneComponent> Component;
+	TEnumAsByte<EComponentMobility::Type> Mobility;
+};
+
+// What the Transformer's per-frame work depends on. Compared with the previous frame to skip work when nothing changed.
+struct FTransformerViewSnapshot
+{
+	FVector CameraLocation = FVector::ZeroVector;
+	FVector CameraForward = FVector::ZeroVector;
+	float FieldOfView = 0.f;
+
+	FVector RayOrigin = FVector::ZeroVector;
+	FVector RayDirection = FVector::ZeroVector;
+	bool bHasMouseRay = false;
+
+	FTransform GizmoParentTransform = FTransform::Identity;
+	FTransform GizmoTransform = FTransform::Identity;
+
+	bool HasSameCamera(const FTransformerViewSnapshot& Other) const
+	{
+		return CameraLocation.Equals(Other.CameraLocation) && CameraForward.Equals(Other.CameraForward)
+			&& FMath::IsNearlyEqual(FieldOfView, Other.FieldOfView);
+	}
+
+	bool HasSameRay(const FTransformerViewSnapshot& Other) const
+	{
+		return bHasMouseRay == Other.bHasMouseRay && RayOrigin.Equals(Other.RayOrigin)
+			&& RayDirection.Equals(Other.RayDirection) && CameraForward.Equals(Other.CameraForward);
+	}
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FAsyncTraceCompletedDelegate, bool, bTracedSuccessfully);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FSelectionSetChangedDelegate, const TArray<class USceneComponent*>&, Added, const TArray<class USceneComponent*>&, Removed);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FSelectionSetChangedNativeDelegate, const TArray<class USceneComponent*>& /*Added*/, const TArray<class USceneComponent*>& /*Removed*/);
+
+// Where a Selected Component sits among the other Selected Components of its attachment hierarchy
+struct FSelectionHierarchyNode
+{
+	// Closest Selected Component above it, explicitly null if it is a Root (moved by the Transform itself)
+	FSelectionHandle Ancestor;
+
+	// Top of its attachment hierarchy. Only the Roots sharing it can end up under a newly Selected Component
+	FSelectionHandle AttachRoot;
+
+	// Number of attach parents above it
+	int32 Depth = 0;
+};
+
 UCLASS()
 class RUNTIMETRANSFORMER_API ATransformerActor : public AActor
 {
@@ -30,9 +108,27 @@ private:
 	// if ActorBased, returns the UFosuable Owner Actor or nullptr (if it doesn't implement)
 	class UObject* GetUFocusable(class USceneComponent* Component) const;
 
+	//Gets the UFocusable Object (see GetUFocusable) and whether its Interface can be called natively
+	FCachedFocusable ResolveFocusable(class USceneComponent* Component) const;
+
 	//Sets the Transform for a Given Component and calls the
-	//Ufocusable transform function called if it implements the Interface
-	void SetTransform(class USceneComponent* Component, const FTransform& Transform);
+	//Ufocusable transform function called if it implements the Interface (its Focusable, resolved at Select)
+	//If the Relative Transform (to its Attach Parent) is already known, it is set directly instead of converting the World Transform
+	void SetTransform(class USceneComponent* Component, const FTransform& Transform, const FTransform* RelativeTransform = nullptr
+		, const FCachedFocusable* Focusable = nullptr);
+
+	//Calls OnNewTransformation on the Focusable (natively if possible)
+	void NotifyFocusable(const FCachedFocusable& Focusable, class USceneComponent* Component, const FTransform& Transform);
+
+	//Calls OnNewTransformations once per Focusable Object, with the Transforms of all its Components in the TransformBuffer
+	// (only the given TransformBuffer entries if any, e.g. the ones a Time Sliced commit set)
+	void NotifyFocusableBatches(const TArray<int32>* Indices = nullptr);
+
+	//The Focusable of the given TransformBuffer entry, or nullptr if it has none
+	const FCachedFocusable* GetTransformFocusable(int32 Index) const
+	{
+		return TransformFocusables[Index].Object.IsExplicitlyNull() ? nullptr : &TransformFocusables[Index];
+	}
 
 	//Called when the Component is added to the SelectedComponent List
 	// Calls the IFocusableObject::Focus if the Component implements the UFocusable interface
@@ -43,12 +139,108 @@ private:
 	void Deselect(class USceneComponent* Component, bool* bImplementsUFocusable = nullptr);
 
 	//Used to Filter unwanted things from a list of OutHits.
+	//Refines the Static Mesh hits to their Triangles if bTriangleAccuratePicking
 	void FilterHits(TArray<FHitResult>& outHits);
 
+	//Makes the next Tick do all of its work, even if the View did not change
+	void MarkViewDirty();
+
+	//Enables Ticking only while there is a Gizmo (if bEventDrivenTick)
+	void RefreshTickState();
+
+	/**
+	 * Tests the Ray against the Gizmo Domain shapes (see ABaseGizmo::TraceTransformationDomain) and sets the Domain if one is hit.
+	 * Called by the Trace Functions before tracing the Scene, if bAnalyticGizmoPicking.
+	 * @return whether a Gizmo Domain was hit
+	 */
+	bool PickGizmoDomain(const FVector& StartLocation, const FVector& EndLocation);
+
+	//Keeps track of the given Async Trace, so that only its result is handled (if still up to date)
+	bool QueueAsyncTrace(const FTraceHandle& TraceHandle, bool bAppendToList);
+
+	//Called by the World with the results of an Async Trace
+	void OnAsyncTraceDone(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	//Adds the Primitives of the Actor that pass ShouldSelect to the Spatial Index
+	void AddActorToSpatialIndex(AActor* Actor);
+	void AddComponentToSpatialIndex(class UPrimitiveComponent* Primitive);
+	void AddSpatialIndexProxy(class UPrimitiveComponent* Primitive);
+	void RemoveActorFromSpatialIndex(AActor* Actor);
+	void RemoveComponentFromSpatialIndex(class UPrimitiveComponent* Primitive);
+
+	//Updates the Spatial Index Bounds of the Components moved since the last query
+	void FlushSpatialIndex();
+
+	//Calls Visitor(Primitive) for every indexed Primitive whose (fat) Bounds intersect the Box. Stale entries are removed.
+	template<typename VisitorType>
+	void QuerySpatialIndex(const FBox& Box, TSubclassOf<AActor> ActorClass, FName ActorTag, VisitorType&& Visitor);
+
+	//Gets the View Projection Matrix and View Rect of the first Player
+	bool GetPlayerViewProjection(FMatrix& OutViewProjection, FIntRect& OutViewRect) const;
+
+	//Fills the ScreenSelectionBuffer with the Bounds of the Selectable Primitives and projects them
+	void GatherScreenSelectionCandidates(const FMatrix& ViewProjection, const FIntRect& ViewRect);
+
+	//Selects the Components of the given ScreenSelectionBuffer entries
+	void SelectScreenSelectionCandidates(const TArray<int32>& Indices, bool bAppendToList);
+
+	//Makes the Selected Component (and its Descendants) Movable, remembering their original Mobility
+	void ForceMovable(const FSelectionHandle& Handle, class USceneComponent* Component);
+
+	//Forgets the original Mobility of the Selected Component, and sets it back if bRestoreMobilityOnDeselect
+	void RestoreMobility(const FSelectionHandle& Handle);
+
+	//Fills the TransformBuffer with the World Transforms of the Selected Components that can be moved
+	void GatherSelectedTransforms();
+
+	/**
+	 * Adds the Delta (around the given Pivot) to DragTotalDelta, so that applying DragTotalDelta to DragStartBuffer
+	 * gives the same result as applying every Delta so far one after the other.
+	 * @return false if the drag can't be expressed that way anymore (it then continues frame by frame)
+	 */
+	bool AccumulateDragDelta(const FTransform& Delta, const FVector& Pivot);
+
+	//Makes the next ApplyDeltaTransform gather the Selected Transforms again
+	void InvalidateTransformBuffer();
+
+	//Sets the Transforms in the TransformBuffer to their Components
+	void CommitTransformBuffer();
+
+	//Sets the Transform of a TransformBuffer entry to its Component (relative to its Attach Space, or in World Space if none)
+	void CommitTransformEntry(int32 Index, const FSelectionAttachSpace* Space);
+
+	/**
+	 * Sets the Transforms in the TransformBuffer that their Components do not have yet, round-robin,
+	 * until the Apply Budget (RuntimeTransformer.ApplyBudgetMs) runs out. The rest are set in the next frames.
+	 */
+	void CommitTransformBufferSliced();
+
+	//Marks every entry of the TransformBuffer as having a Transform that was not set to its Component yet
+	void MarkTransformBufferStale();
+
+	//Sets the Lagging Components / Max Staleness stats
+	void UpdateLaggingStats() const;
+
+	//Called when the Domain changes from None (a Transform starts)
+	void OnTransformBegin();
+
+	//Called when the Domain changes to None (a Transform ends)
+	void OnTransformEnd();
+
+	//Starts Previewing the Transform in progress with the Proxy instead of moving the Selected Components
+	void BeginTransformPreview();
+
+	//Moves the Proxy (and the Gizmo) to match the TransformBuffer after a Delta was applied to it
+	void UpdateTransformPreview(const FTransform& DeltaTransform, const FVector& Pivot);
+
+	//Hides the Proxy and commits the TransformBuffer to the Selected Components
+	void EndTransformPreview();
+
 public:
 
 	/*
-	* This gets called everytime a Component / Actor is going to get added.
+	* This gets called everytime a Component / Actor is going to get added, if the Selection Filter did not decide already
+	* (see SelectionFilterRules and GetSelectionFilter). Rules that only depend on class or tags are much faster there.
 	* The default return is TRUE, but it can be overriden to check for additional things
 	* (e.g. checking if it implements an interface, has some property, is child of a class, etc)
 
@@ -83,6 +275,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	void ClearDomain();
 
+	/**
+	 * Puts the Selected Components back to the Transforms they had when the Transform in progress started,
+	 * and ends it (like ClearDomain).
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void CancelTransform();
+
 	//Gets the Start and End Points of the Mouse based on the Player Controller possessing this pawn
 	// returns true if outStartPoint and outEndPoint were given a successful value
 	bool CalculateMouseWorldPosition(float TraceDistance, FVector& outStartPoint, FVector& outEndPoint);
@@ -215,6 +414,140 @@ public:
                         , bool bAppendToList = false
                         , bool bTraceComplex = false);
 
+	/**
+	 * Async version of TraceByObjectTypes. The Gizmo is still picked right away (if bAnalyticGizmoPicking),
+	 * but the Scene Trace runs in the Async Trace pass and its result is handled the next frame (see OnAsyncTraceCompleted).
+	 * Results are discarded if the Selection or Domain changed meanwhile, or if a newer Async Trace was requested.
+	 * @return true if the Gizmo was picked right away or the Trace was queued
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool AsyncTraceByObjectTypes(const FVector& StartLocation
+		, const FVector& EndLocation
+		, TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels
+		, TArray<AActor*> IgnoredActors
+		, bool bAppendToList = false
+		, bool bTraceComplex = false);
+
+	// Async version of TraceByChannel. @see AsyncTraceByObjectTypes
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool AsyncTraceByChannel(const FVector& StartLocation
+		, const FVector& EndLocation
+		, TEnumAsByte<ECollisionChannel> TraceChannel
+		, TArray<AActor*> IgnoredActors
+		, bool bAppendToList = false
+		, bool bTraceComplex = false);
+
+	// Async version of TraceByProfile. @see AsyncTraceByObjectTypes
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool AsyncTraceByProfile(const FVector& StartLocation
+		, const FVector& EndLocation
+		, const FName& ProfileName
+		, TArray<AActor*> IgnoredActors
+		, bool bAppendToList = false
+		, bool bTraceComplex = false);
+
+	// Makes a reusable Trace Query (see TraceWithQuery) that traces the given Object Types
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	static FTransformerTraceQuery MakeTraceQueryByObjectTypes(const TArray<TEnumAsByte<ECollisionChannel>>& CollisionChannels
+		, const TArray<AActor*>& IgnoredActors
+		, bool bTraceComplex = false);
+
+	// Makes a reusable Trace Query (see TraceWithQuery) that traces the given Channel
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	static FTransformerTraceQuery MakeTraceQueryByChannel(TEnumAsByte<ECollisionChannel> TraceChannel
+		, const TArray<AActor*>& IgnoredActors
+		, bool bTraceComplex = false);
+
+	// Makes a reusable Trace Query (see TraceWithQuery) that traces the given Profile
+	UFUNCTION(BlueprintPure, Category = "Runtime Transformer")
+	static FTransformerTraceQuery MakeTraceQueryByProfile(FName ProfileName
+		, const TArray<AActor*>& IgnoredActors
+		, bool bTraceComplex = false);
+
+	/**
+	 * Same as the other Trace Functions, but with a Query made once (e.g. at BeginPlay) and kept by the caller,
+	 * so the Collision Params and Hits are not rebuilt every time.
+	 * If the Gizmo is picked analytically (bAnalyticGizmoPicking), only the first blocking hit is traced
+	 * (see FTransformerTraceQuery::bSingleBlockingHit), since HandleTracedObjects only needs the first one (unless bTriangleAccuratePicking).
+	 * If that hit is a Gizmo, the Query is traced again for all the hits.
+	 * @param Query - Query made with MakeTraceQueryBy*. Its Hits are overwritten.
+	 * @return bool Whether there was an Object traced successfully
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool TraceWithQuery(UPARAM(ref) FTransformerTraceQuery& Query
+		, const FVector& StartLocation
+		, const FVector& EndLocation
+		, bool bAppendToList = false);
+
+	// TraceWithQuery from the Mouse Position. @see TraceWithQuery
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	bool MouseTraceWithQuery(UPARAM(ref) FTransformerTraceQuery& Query
+		, float TraceDistance
+		, bool bAppendToList = false);
+
+	/**
+	 * Rebuilds the Spatial Index from every Actor in the World (see bMaintainSpatialIndex).
+	 * Should be called if the ShouldSelect rules change (SetSelectionFilterRules already does it).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void RebuildSpatialIndex();
+
+	/**
+	 * Gets the Selectable Components whose Bounds intersect the given Box, without going through the Physics Scene.
+	 * Only works if bMaintainSpatialIndex. Components are Primitives if Component Based, else the Root Components of the Actors.
+	 * @param ActorClass - if set, only Components whose Owner is of this class are returned
+	 * @param ActorTag - if set, only Components whose Owner has this Tag are returned
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	TArray<class USceneComponent*> QuerySpatialIndexBox(const FBox& Box
+		, TSubclassOf<AActor> ActorClass = nullptr
+		, FName ActorTag = NAME_None);
+
+	// Same as QuerySpatialIndexBox, but with the Components whose Bounds intersect the given Sphere
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	TArray<class USceneComponent*> QuerySpatialIndexRadius(const FVector& Center
+		, float Radius
+		, TSubclassOf<AActor> ActorClass = nullptr
+		, FName ActorTag = NAME_None);
+
+	/**
+	 * Selects the Selectable Components whose Screen Bounds are in the Screen Rect between the given points (Marquee Selection),
+	 * as seen by the first Player's View. Does not use Physics: Bounds are projected to the Screen in batches (SIMD).
+	 * @param ScreenStart, ScreenEnd - opposite corners of the Rect, in Viewport pixels (e.g. Mouse Positions)
+	 * @param bRequireFullyInside - whether the whole Screen Bounds have to be in the Rect (else intersecting is enough)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void MarqueeSelect(const FVector2D& ScreenStart
+		, const FVector2D& ScreenEnd
+		, bool bAppendToList = false
+		, bool bRequireFullyInside = false);
+
+	/**
+	 * Selects the Selectable Components whose Screen Bounds Center is inside the given Polygon (Lasso Selection),
+	 * as seen by the first Player's View. @see MarqueeSelect
+	 * @param ScreenPoints - Polygon in Viewport pixels (closed automatically)
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void LassoSelect(const TArray<FVector2D>& ScreenPoints
+		, bool bAppendToList = false);
+
+	// MarqueeSelect with the given View, so it does not need a Player or Viewport
+	void MarqueeSelectInView(const FBox2D& ScreenRect
+		, const FMatrix& ViewProjection
+		, const FIntRect& ViewRect
+		, bool bAppendToList = false
+		, bool bRequireFullyInside = false);
+
+	// LassoSelect with the given View, so it does not need a Player or Viewport
+	void LassoSelectInView(TConstArrayView<FVector2D> ScreenPoints
+		, const FMatrix& ViewProjection
+		, const FIntRect& ViewRect
+		, bool bAppendToList = false);
+
+	// Called when the result of the latest Async Trace has been handled (not called for discarded results)
+	UPROPERTY(BlueprintAssignable, Category = "Runtime Transformer")
+	FAsyncTraceCompletedDelegate OnAsyncTraceCompleted;
+
 	// Update every Frame
 	// Checks for Mouse Update
 	virtual void Tick(float DeltaSeconds) override;
@@ -241,9 +574,26 @@ public:
 	FTransform UpdateTransform(const FVector& LookingVector
 		, const FVector& RayOrigin, const FVector& RayDirection);
 
+	/**
+	 * Applies the Delta Transform to every Selected Component (around the Gizmo).
+	 * While a Transform is in progress, the Selected Transforms are gathered once (at the first call)
+	 * and kept in the TransformBuffer, so they should not be moved by something else meanwhile.
+	 */
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	void ApplyDeltaTransform(const FTransform& DeltaTransform);
 
+	/**
+	 * Number of Components that have not been given their latest Transform yet, because the Apply Budget
+	 * (console variable RuntimeTransformer.ApplyBudgetMs) ran out. They catch up in the next frames, and all of them
+	 * get their final Transform when the Transform ends. Always 0 if the Apply Budget is 0 (no Time Slicing).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	int32 GetNumLaggingComponents() const { return NumLaggingTransforms; }
+
+	// How many frames behind the most out of date lagging Component is (0 if none is lagging)
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	int32 GetMaxStalenessFrames() const;
+
 	/**
 	 * Processes the OutHits generated by Tracing and Selects either a Gizmo (priority) or
 	 * if no Gizmo is present in the trace, the first object hit is selected.
@@ -299,6 +649,16 @@ public:
 	    }
 	}
 
+	/**
+	 * Called once per selection operation (e.g. a SelectMultipleComponents call or a committed Selection Transaction)
+	 * with all the Components that were Selected (Added) and Deselected (Removed) by it.
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Runtime Transformer")
+	FSelectionSetChangedDelegate OnSelectionSetChanged;
+
+	// Native version of OnSelectionSetChanged, broadcast right before it
+	FSelectionSetChangedNativeDelegate OnSelectionSetChangedNative;
+
 public:
 
 	/**
@@ -432,28 +792,116 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
 	TArray<class USceneComponent*> DeselectAll(bool bDestroyDeselected = false);
 
+	/**
+	 * Replaces the Class and Tag rules of the Selection Filter (clearing its per-class cache).
+	 * The Spatial Index is rebuilt, since what is Selectable may have changed.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void SetSelectionFilterRules(const FSelectionFilterRules& Rules);
+
+	/**
+	 * The native Selection Filter, to register C++ rules (AddClassRule / AddInstanceRule).
+	 * RebuildSpatialIndex should be called after changing them if bMaintainSpatialIndex.
+	 */
+	FSelectionFilter& GetSelectionFilter() { return SelectionFilter; }
+
+	/**
+	 * Gets the Components of the given list that would be Selected (Selection Filter, then ShouldSelect if needed),
+	 * evaluating the Filter on the whole list in one call.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void FilterSelectableComponents(const TArray<class USceneComponent*>& Components
+		, TArray<class USceneComponent*>& OutSelectableComponents);
+
+	/**
+	 * Applies a whole Selection diff in one pass: first deselects the Components to Remove,
+	 * then selects the Components to Add (already selected ones are not toggled).
+	 * The Gizmo is placed only once, after the whole diff is applied.
+	 * @param ComponentsToAdd - the Components to add to the Selection (ShouldSelect is still checked)
+	 * @param ComponentsToRemove - the Components to remove from the Selection
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void ApplySelectionChange(const TArray<class USceneComponent*>& ComponentsToAdd
+		, const TArray<class USceneComponent*>& ComponentsToRemove);
+
+	/**
+	 * Starts a Selection Transaction. Until the matching CommitSelectionTransaction is called,
+	 * Selecting / Deselecting does not update the Gizmo (placement, attachment and space).
+	 * Transactions can be nested, the Gizmo is updated once when the outermost one is committed.
+	 * @see FScopedSelectionTransaction for C++
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void BeginSelectionTransaction();
+
+	/**
+	 * Ends a Selection Transaction started with BeginSelectionTransaction.
+	 * If it is the outermost one and the Selection changed, the Gizmo is updated once.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Runtime Transformer")
+	void CommitSelectionTransaction();
+
 private:
 
 	/*
 	The core functionality, but can be called by Selection of Multiple objects
 	so as to not call UpdateGizmo every time
 	*/
-	void AddComponent_Internal(TArray<class USceneComponent*>& OutComponentList
+	void AddComponent_Internal(TOrderedSelectionSet<FSelectionHandle>& OutComponentList
 		, class USceneComponent* Component);
 
 	/*
 	The core functionality, but can be called by Selection of Multiple objects
 	so as to not call UpdateGizmo every time
 	*/
-	void DeselectComponent_Internal(TArray<class USceneComponent*>& OutComponentList
+	void DeselectComponent_Internal(TOrderedSelectionSet<FSelectionHandle>& OutComponentList
 		, class USceneComponent* Component);
-	void DeselectComponentAtIndex_Internal(TArray<class USceneComponent*>& OutComponentList
-		, int32 Index);
-    class ABaseGizmo* CreateGizmo(ETransformationType transformationType);
+
+	//Whether any Component above the given Selected one in its attachment hierarchy is Selected (a lookup in SelectionHierarchy)
+	bool HasSelectedAncestor(const FSelectionHandle& Component) const;
+
+	//Keeps SelectionHierarchy up to date when the given Component is Selected / Deselected
+	void UpdateSelectionHierarchy(class USceneComponent* Component, bool bSelected);
+
+	//Finds the closest Selected ancestor, attach root and depth of the Component
+	void ResolveSelectionNode(class USceneComponent* Component, FSelectionHierarchyNode& OutNode) const;
+
+	//Adds / Removes the Component under its Node's Ancestor in NestedSelectedChildren (or in SelectedRoots if it has none)
+	void LinkSelectionNode(const FSelectionHandle& Component, const FSelectionHierarchyNode& Node);
+	void UnlinkSelectionNode(const FSelectionHandle& Component, const FSelectionHierarchyNode& Node);
+
+	//Whether the Component can be Selected: the Selection Filter decides, and ShouldSelect is only called if it asks for it
+	bool IsSelectable(AActor* OwnerActor, class USceneComponent* Component);
+
+	//Turns a Selection Filter result into whether the Component can be Selected (calling ShouldSelect if needed)
+	bool ResolveSelectionFilterResult(ESelectionFilterResult Result, AActor* OwnerActor, class USceneComponent* Component);
+
+	//Adds the Selected Components that are still valid to the given Array, in Selection order
+	void ResolveSelectedComponents(TArray<class USceneComponent*>& OutComponents) const;
+
+	/**
+	 * Removes the Selection entries whose Component was destroyed (or streamed out) since the last check.
+	 * Runs at most once per frame, so it can be called before any work on the Selection.
+	 */
+	void PruneInvalidSelection();
+
+	//Moves the Selected Components of the removed Level to StreamedOutSelection (if bKeepStreamedOutSelection)
+	void OnLevelRemovedFromWorld(class ULevel* Level, UWorld* World);
+
+	//Selects again the StreamedOutSelection Components that are back
+	void OnLevelAddedToWorld(class ULevel* Level, UWorld* World);
+
+	//Drops the destroyed Components from the buffers kept between frames, since they hold raw pointers
+	void OnPostGarbageCollect();
+
+    //The World's shared Gizmo Pool (nullptr if there is no World)
+    class UGizmoPoolSubsystem* GetGizmoPool() const;
+
+    //The World's shared Mesh Triangle BVH cache (nullptr if there is no World)
+    class UMeshPickingSubsystem* GetMeshPicking() const;
 
     /**
 	 * Creates / Replaces Gizmo with the Current Transformation.
-	 * It destroys any current active gizmo to replace it.
+	 * It gives any current active gizmo back to the Gizmo Pool to replace it.
 	*/
 	void SetGizmo();
     void ResetGizmo();
@@ -464,9 +912,31 @@ private:
 	*/
 	void UpdateGizmoPlacement();
 
-	//Gets the respective assigned class for a given TransformationType
+	// Updates the Gizmo Placement and broadcasts OnSelectionSetChanged right away,
+	// or once the current Selection Transaction is committed
+	void FlushSelectionChange();
+
+	// Keeps track of the Components added/removed since the last OnSelectionSetChanged broadcast
+	void RecordSelectionChange(class USceneComponent* Component, bool bSelected);
+
+	// Broadcasts OnSelectionSetChanged (if anything changed) and clears the pending changes
+	void BroadcastSelectionSetChanged();
+
+	//Gets the respective assigned class for a given TransformationType (nullptr if it is not loaded yet)
 	UClass* GetGizmoClass(ETransformationType TransformationType) const;
 
+	/**
+	 * Starts streaming in the Gizmo Classes that are not loaded yet.
+	 * @return true if there is nothing left to load, false if OnGizmoClassesLoaded will be called later
+	 */
+	bool RequestGizmoClasses();
+
+	//Prewarms the Gizmo Pool and shows the Gizmo if there is a Selection waiting for it
+	void OnGizmoClassesLoaded();
+
+	//Spawns the Gizmos of every loaded Gizmo Class in the shared Gizmo Pool
+	void PrewarmGizmoPool();
+
 	//Resets the transform to all Zeros (including Scale)
 	static void ResetDeltaTransform(FTransform& Transform);
 
@@ -487,7 +957,7 @@ private:
 	 * to allow the user to customize gizmo functionality
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gizmo", meta = (AllowPrivateAccess = "true"))
-	TSubclassOf<class ATranslationGizmo> TranslationGizmoClass;
+	TSoftClassPtr<class ATranslationGizmo> TranslationGizmoClass;
 
 	/**
 	 * GizmoClasses are variables that specified which Gizmo to spawn for each
@@ -495,7 +965,7 @@ private:
 	 * to allow the user to customize gizmo functionality
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gizmo", meta = (AllowPrivateAccess = "true"))
-	TSubclassOf<class ARotationGizmo> RotationGizmoClass;
+	TSoftClassPtr<class ARotationGizmo> RotationGizmoClass;
 
 	/**
 	 * GizmoClasses are variables that specified which Gizmo to spawn for each
@@ -503,13 +973,84 @@ private:
 	 * to allow the user to customize gizmo functionality
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gizmo", meta = (AllowPrivateAccess = "true"))
-	TSubclassOf<class AScaleGizmo> ScaleGizmoClass;
+	TSoftClassPtr<class AScaleGizmo> ScaleGizmoClass;
+
+	/**
+	 * Whether the Gizmo Classes (and their meshes and materials) start streaming in at BeginPlay.
+	 * If false, they are only loaded on the first Selection, and the Gizmo appears once they are loaded.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gizmo", meta = (AllowPrivateAccess = "true"))
+	bool bPreloadGizmoClasses;
+
+	/**
+	 * Whether the Trace Functions test the Gizmo analytically (against the shapes of its Domain Components) before tracing the Scene.
+	 * This does not depend on the Gizmo Collision, and picks the Gizmo even if it is behind other objects.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gizmo", meta = (AllowPrivateAccess = "true"))
+	bool bAnalyticGizmoPicking;
+
+	/**
+	 * Whether the Gizmo has Collision (is in the Physics Scene) while it is used.
+	 * Can be disabled if bAnalyticGizmoPicking is used, so the Gizmo Components do not have to be moved in the Physics Scene.
+	 * Custom traces passed to HandleTracedObjects need it to hit the Gizmo.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Gizmo", meta = (AllowPrivateAccess = "true"))
+	bool bGizmoCollision;
+
+	/**
+	 * Whether Trace hits on Static Meshes are refined to the exact Triangle hit (see UMeshPickingSubsystem),
+	 * so thin or concave Meshes can be picked precisely with Simple Collision (without bTraceComplex).
+	 * Hits whose Ray misses every Triangle of the Mesh are discarded. Meshes without CPU accessible
+	 * Triangles (no "Allow CPU Access" in cooked builds) keep their Collision hit.
+	 * Objects behind a discarded blocking hit are only found if the Trace overlaps (rather than blocks) the discarded Mesh.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bTriangleAccuratePicking;
+
+	/**
+	 * Whether to keep a Spatial Index (Dynamic AABB Tree) of the Selectable Components (that pass ShouldSelect) in the World,
+	 * so that they can be queried by Box / Radius without Physics (see QuerySpatialIndexBox).
+	 * It is built at BeginPlay and kept up to date when Components are moved by the Transformer, spawned, cloned or destroyed.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bMaintainSpatialIndex;
+
+	// How much the Bounds stored in the Spatial Index are grown by, so that small moves do not need to update it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float SpatialIndexMargin;
+
+	TDynamicAABBTree<TObjectKey<class UPrimitiveComponent>> SpatialIndex;
+
+	// Proxy Id of every Primitive in the Spatial Index (Object Keys, so a destroyed Component is never confused with a new one)
+	TMap<TObjectKey<class UPrimitiveComponent>, int32> SpatialIndexProxies;
+
+	// Components moved since the Spatial Index was last updated (their Children moved too)
+	TSet<TWeakObjectPtr<class USceneComponent>> SpatialIndexDirtyComponents;
+
+	// Candidates of the latest Marquee / Lasso Selection (kept to reuse its allocations)
+	FScreenSelectionBuffer ScreenSelectionBuffer;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+
+	// Delegate given to the World Async Traces
+	FTraceDelegate AsyncTraceDelegate;
+
+	// The latest Async Trace requested (older ones are discarded)
+	FTraceHandle PendingAsyncTrace;
+
+	// bAppendToList of the latest Async Trace
+	bool bPendingAsyncTraceAppend;
+
+	// Incremented every time the Selection or Domain changes. Async Trace results from an older revision are discarded
+	uint32 SelectionRevision;
+
+	// Handle of the async load of the Gizmo Classes (keeps them loaded)
+	TSharedPtr<struct FStreamableHandle> GizmoClassesHandle;
 
 	UPROPERTY()
 	TWeakObjectPtr<class ABaseGizmo> Gizmo;
 
-    TArray<TWeakObjectPtr<ABaseGizmo>> GizmoActorPool;
-
 	// Tell which Domain is Selected. If NONE, then that means that there is no Selected Objects, or
 	// that the Gizmo has not been hit yet.
 	ETransformationDomain CurrentDomain;
@@ -523,10 +1064,136 @@ private:
 	ETransformationType CurrentTransformation;
 
 	/**
-	 * Array storing Selected Components. Although a quick O(1) removal is needed (like a Set),
-	 * it is Crucial that we maintain the order of the elements as they were selected
+	 * Set storing (Weak Handles to) the Selected Components. Contains/Add/Remove are O(1)
+	 * and the order of the elements as they were selected is maintained (needed for Gizmo Placement)
+	 */
+	TOrderedSelectionSet<FSelectionHandle> SelectedComponents;
+
+	/**
+	 * Class and Tag rules deciding what is Selectable before ShouldSelect is called.
+	 * Their results are cached per class, so large selections do not call ShouldSelect for every candidate.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	FSelectionFilterRules SelectionFilterRules;
+
+	/**
+	 * Whether ShouldSelect is called for the candidates no Selection Filter rule decided about.
+	 * If false, those are Selectable and ShouldSelect only runs for the candidates a rule asks it for (AskShouldSelect).
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bCallShouldSelectByDefault;
+
+	FSelectionFilter SelectionFilter;
+
+	// Whether ShouldSelect is implemented in Blueprint. If not, its native implementation is called directly (no Blueprint thunk)
+	bool bShouldSelectInScript;
+
+	// Frame at which PruneInvalidSelection last ran
+	uint64 SelectionValidationFrame;
+
+	/**
+	 * Whether the Selected Components of a Level being streamed out (e.g. a World Partition Cell) are remembered
+	 * and Selected again when their Level streams back in. Otherwise they are just removed from the Selection.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bKeepStreamedOutSelection;
+
+	// Paths of the Selected Components that were streamed out (see bKeepStreamedOutSelection)
+	TArray<FSoftObjectPath> StreamedOutSelection;
+
+	FDelegateHandle LevelRemovedHandle;
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle PostGarbageCollectHandle;
+
+	// World Transforms of the Selected (movable) Components, kept while a Transform is in progress
+	FSelectionTransformBuffer TransformBuffer;
+
+	// Focusable of every Selected Component that has one (resolved at Select, so Transforming does not go through reflection)
+	TMap<FSelectionHandle, FCachedFocusable> FocusableCache;
+
+	// Focusable of every entry of TransformBuffer (with a null Object if it has none)
+	TArray<FCachedFocusable> TransformFocusables;
+
+	/**
+	 * Whether UFocusable Objects get a single OnNewTransformations call per frame with all of their Components' Transforms,
+	 * (after the Transforms were set) instead of an OnNewTransformation call per Component.
 	 */
-	TArray<class USceneComponent*> SelectedComponents;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bBatchFocusableNotifications;
+
+	// Indices in TransformBuffer of UFocusable Components we do not move ourselves (bTransformUFocusableObjects is false)
+	TArray<int32> UnappliedTransformIndices;
+
+	/*
+	 * Whether every frame of a Transform computes the new Transforms from the ones the Components had when it started
+	 * and the total Delta so far, instead of adding the Delta of that frame to the Transforms of the last one.
+	 * Floating point error and snapping remainders then do not build up over long drags.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bTransformFromDragStart;
+
+	// TransformBuffer as it was gathered when the Transform in progress started (what CancelTransform restores)
+	FSelectionTransformBuffer DragStartBuffer;
+
+	// Whether DragStartBuffer was taken for the Transform in progress
+	bool bDragStartValid;
+
+	// Whether TransformBuffer is still DragStartBuffer with DragTotalDelta applied
+	// (false once the Selection changed, or a drag both Rotated and Scaled, in the middle of the Transform)
+	bool bDragStartAligned;
+
+	// Every Delta applied since the Transform started, as a single Delta around DragPivot
+	FTransform DragTotalDelta;
+	FVector DragPivot;
+	bool bDragRotateOnLocalAxis;
+
+	// Entries of TransformBuffer in the order a Time Sliced commit goes through them (by Attach Group),
+	// and the Attach Group of each (INDEX_NONE for World Space entries)
+	TArray<int32> SlicedCommitOrder;
+	TArray<int32> SlicedCommitGroups;
+
+	// Position in SlicedCommitOrder where the next Time Sliced commit starts
+	int32 SlicedCommitCursor;
+
+	// GFrameCounter + 1 of when each TransformBuffer entry got a Transform its Component does not have yet (0 if up to date)
+	TArray<uint64> TransformStaleSince;
+	int32 NumLaggingTransforms;
+
+	// Frame of the last Time Sliced commit, so catching up in Tick does not spend the Apply Budget twice
+	uint64 SlicedCommitFrame;
+
+	// Whether TransformBuffer holds the current Selection
+	bool bTransformBufferValid;
+
+	/**
+	 * Closest Selected ancestor (and attach root / depth) of every Selected Component, updated on every Select / Deselect.
+	 * Components with a Selected ancestor are Nested: moving their ancestor already moves them, so only the Roots are Transformed.
+	 */
+	TMap<FSelectionHandle, FSelectionHierarchyNode> SelectionHierarchy;
+
+	// Nested Components by their closest Selected ancestor
+	TMultiMap<FSelectionHandle, FSelectionHandle> NestedSelectedChildren;
+
+	// Root Components by the top of their attachment hierarchy
+	TMultiMap<FSelectionHandle, FSelectionHandle> SelectedRoots;
+
+	// How many Selection Transactions are currently open (they can be nested)
+	int32 SelectionTransactionDepth;
+
+	// Whether the Selection changed during the current Transaction and the Gizmo must be updated on Commit
+	bool bSelectionChangePending;
+
+	// Components Selected / Deselected since OnSelectionSetChanged was last broadcast
+	TOrderedSelectionSet<FSelectionHandle> PendingSelectedComponents;
+	TOrderedSelectionSet<FSelectionHandle> PendingDeselectedComponents;
+
+	/**
+	 * Whether OnComponentSelectionChange is called for every Component Selected / Deselected.
+	 * Set to false for large selections and use OnSelectionSetChanged instead, so that a selection operation costs one dispatch.
+	 * NOTE: the default OnComponentSelectionChange is what enables the Custom Depth outline.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bBroadcastPerComponentSelectionChange;
 
 	/*
 	* Map storing the Snap values for each transformation
@@ -547,13 +1214,27 @@ private:
 
 	/**
 	* Whether to Force Mobility on items that are not Moveable
-	* if true, Mobility on Components will be changed to Moveable (WARNING: does not set it back to its original mobility!)
+	* if true, Mobility on Components will be changed to Moveable once, when they are first Transformed
+	* (their original Mobility is set back on Deselect if bRestoreMobilityOnDeselect)
 	* if false, no movement transformations will be attempted on Static/Stationary Components
 
 	*/
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
 	bool bForceMobility;
 
+	/**
+	 * Whether the Components whose Mobility was forced to Movable (bForceMobility) get their original Mobility back
+	 * when Deselected, so Static Components go back to Static Lighting and Culling.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bRestoreMobilityOnDeselect;
+
+	// Components made Movable by bForceMobility (the Selected Component and its Descendants), per Selected Component
+	TMap<FSelectionHandle, TArray<FForcedMobility, TInlineAllocator<1>>> ForcedMobilities;
+
+	// Selected Components already reported as not Movable (reported once per Selection)
+	TSet<FSelectionHandle> UnmovableReportedComponents;
+
 	/*
 	 * This property only matters when multiple objects are selected.
 	 * Whether multiple objects should rotate on their local axes (true) or on the axes the Gizmo is in (false)
@@ -561,6 +1242,79 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
 	bool bRotateOnLocalAxis;
 
+	/*
+	 * Minimum amount of Components being transformed for the new Transforms to be computed in parallel (worker threads).
+	 * Below it (or if 0) they are computed serially on the Game Thread. Either way they are applied on the Game Thread.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	int32 ParallelApplyThreshold;
+
+	/*
+	 * Whether to move all the Components of a frame inside Scoped Movement Updates,
+	 * so that Child Transform and Overlap updates run once per Component after all of them were moved.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bBatchTransformCommit;
+
+	/*
+	 * Whether to stop updating the Overlaps of the Selected Components (and their children) while a Transform is in progress.
+	 * Overlap Events are disabled on them when the Transform starts and re-enabled (and updated once) when it ends.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bDeferOverlapsDuringTransform;
+
+	/*
+	 * Whether the Transformer only Ticks while a Gizmo is present, and only updates the Transform,
+	 * Gizmo Space and Gizmo Scale when the Camera, Mouse Ray, Space Type or Gizmo attachment changed since the last frame.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	bool bEventDrivenTick;
+
+	// The View the last Tick worked with
+	FTransformerViewSnapshot LastView;
+
+	// Whether the next Tick has to do all of its work
+	bool bViewDirty;
+
+	// Primitives whose Overlap Events were disabled by bDeferOverlapsDuringTransform
+	TArray<TWeakObjectPtr<class UPrimitiveComponent>> OverlapDeferredComponents;
+
+	/*
+	 * Minimum amount of Components being transformed for the Transform to be Previewed (0 disables Previewing).
+	 * While Previewing, only a Proxy (a box per Component, fit to its bounds) and the Gizmo move.
+	 * The Selected Components get the final Transform once, when the Transform ends (ClearDomain).
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true", ClampMin = "0"))
+	int32 PreviewProxyThreshold;
+
+	// Mesh instanced for every Component while Previewing (scaled to the Component bounds). If none, only the Gizmo moves.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<class UStaticMesh> PreviewProxyMesh;
+
+	// Optional Material for the Preview Proxy Mesh
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
+	TObjectPtr<class UMaterialInterface> PreviewProxyMaterial;
+
+	UPROPERTY(Transient)
+	TObjectPtr<class UInstancedStaticMeshComponent> PreviewProxy;
+
+	// Transform of each Proxy instance relative to its Component
+	TArray<FTransform> PreviewProxyLocalBounds;
+
+	// Transform applied to the whole Proxy while every Delta has been rigid (no scaling, no local rotation)
+	FTransform PreviewRigidTransform;
+
+	// Gizmo relative to the Component it is attached to (PreviewGizmoAnchorIndex in the TransformBuffer)
+	FTransform PreviewGizmoOffset;
+	FTransform PreviewGizmoStartRelativeTransform;
+	int32 PreviewGizmoAnchorIndex;
+
+	// Whether the TransformBuffer has previewed Transforms that have not been set to the Components yet
+	bool bPreviewCommitPending;
+
+	// Whether the Proxy instances are still placed at their start Transforms (moved as a whole by PreviewRigidTransform)
+	bool bPreviewRigid;
+
 	/**
 	 * Whether to Apply the Transforms to objects that Implement the UFocusable Interface.
 	 * if True, the Transforms will be applied.
@@ -587,3 +1341,25 @@ protected:
     UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Runtime Transformations", meta = (AllowPrivateAccess = "true"))
     FName AttachSocketName = NAME_None;
 };
+
+/**
+ * Opens a Selection Transaction on the given Transformer for the lifetime of this object
+ * @see ATransformerActor::BeginSelectionTransaction
+ */
+class FScopedSelectionTransaction
+{
+public:
+	explicit FScopedSelectionTransaction(ATransformerActor* InTransformer)
+		: Transformer(InTransformer)
+	{
+		if (Transformer) Transformer->BeginSelectionTransaction();
+	}
+
+	~FScopedSelectionTransaction()
+	{
+		if (Transformer) Transformer->CommitSelectionTransaction();
+	}
+
+private:
+	ATransformerActor* Transformer;
+};
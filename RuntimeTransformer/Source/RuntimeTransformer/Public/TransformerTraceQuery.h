@@ -0,0 +1,71 @@
+// Copyright 2020 Juan Marcelo Portillo. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/HitResult.h"
+#include "CollisionQueryParams.h"
+#include "TransformerTraceQuery.generated.h"
+
+/**
+ * A Selection Trace whose parameters are built once and reused every time it is traced.
+ *
+ * The Collision Params (and Ignored Actors) are only built when the Query is made, and the Hits
+ * are kept in the Query so tracing it again does not allocate once the Hits array has grown.
+ * Make it with the ATransformerActor::MakeTraceQueryBy* functions and trace it with TraceWithQuery / MouseTraceWithQuery.
+ */
+USTRUCT(BlueprintType)
+struct RUNTIMETRANSFORMER_API FTransformerTraceQuery
+{
+	GENERATED_BODY()
+
+	enum class EQueryType : uint8
+	{
+		None,
+		ObjectTypes,
+		Channel,
+		Profile,
+	};
+
+	FTransformerTraceQuery();
+
+	static FTransformerTraceQuery ByObjectTypes(const TArray<TEnumAsByte<ECollisionChannel>>& CollisionChannels
+		, const TArray<AActor*>& IgnoredActors, bool bTraceComplex);
+
+	static FTransformerTraceQuery ByChannel(ECollisionChannel TraceChannel
+		, const TArray<AActor*>& IgnoredActors, bool bTraceComplex);
+
+	static FTransformerTraceQuery ByProfile(FName ProfileName
+		, const TArray<AActor*>& IgnoredActors, bool bTraceComplex);
+
+	bool IsValid() const { return QueryType != EQueryType::None; }
+
+	/**
+	 * Traces the World and fills Hits.
+	 * @param bSingleHit - whether only the first blocking hit is needed (single trace instead of a multi trace)
+	 * @return whether anything was hit
+	 */
+	bool Trace(const UWorld* World, const FVector& StartLocation, const FVector& EndLocation, bool bSingleHit);
+
+	// Hits of the last Trace
+	TArray<FHitResult> Hits;
+
+	/**
+	 * Whether TraceWithQuery only traces the first blocking hit (a single trace instead of a multi trace)
+	 * when the Gizmo is picked analytically. Overlap responses are ignored by it: disable this if an object
+	 * the trace overlaps in front of the blocking hit should be Selected, as with the other Trace Functions.
+	 */
+	UPROPERTY(BlueprintReadWrite, Category = "Runtime Transformer")
+	bool bSingleBlockingHit;
+
+private:
+
+	EQueryType QueryType;
+
+	ECollisionChannel TraceChannel;
+	FName ProfileName;
+
+	FCollisionQueryParams QueryParams;
+	FCollisionObjectQueryParams ObjectQueryParams;
+};